@@ -1,33 +1,137 @@
 #include "handlers/CommandHandler.cpp"
 #include "handlers/DisplayHandler.cpp"
 #include "handlers/KeyboardHandler.cpp"
-#include "handlers/MarqueeLogicHandler.cpp"
-#include <thread>
+#include "handlers/MarqueeLanes.cpp"
+#include "handlers/ControlSocketHandler.cpp"
+#include "utils/FramePack.cpp"
+#include "utils/SpscRing.cpp"
+#include "utils/WakeSignal.cpp"
+#include "utils/LatencyStats.cpp"
+#include "utils/FixedStepClock.cpp"
+#include "utils/ThreadPool.cpp"
+#include <atomic>
 #include <chrono>
-#include <fstream>
-#include <filesystem>
+#include <deque>
+#include <functional>
+#include <thread>
+
+// Ring sizes between the pipeline stages (powers of two)
+#define KEY_QUEUE_SIZE 256
+#define RENDER_QUEUE_SIZE 64
+
+// How soon the logic stage retries messages the render stage had no room for
+#define RENDER_RETRY_MS 1
+
+// Missed animation ticks made up in one pass; beyond this they are dropped
+#define MAX_CATCH_UP_TICKS 8
+
+// Shortest time between animation frames; faster marquee speeds move several columns per frame
+#define MIN_FRAME_MS 10
 
+/**
+ * Kinds of update the logic stage sends to the render stage
+ */
+enum RenderMessageType
+{
+    RENDER_INPUT_LINE,       // text: the line being typed, keyReadAt: when its oldest key was read
+    RENDER_CONSOLE_OUTPUT,   // lines: command response or message for the text console
+    RENDER_MARQUEE_FRAME,    // MarqueeLanes published a new band
+    RENDER_GIF_FRAME,        // frameIndex: GIF frame to apply as a delta
+    RENDER_SCROLL,           // scrollPages: pages to scroll the text console back (negative: forward)
+    RENDER_SHUTDOWN          // The logic stage has stopped
+};
+
+/**
+ * One update for DisplayHandler, passed from the logic stage to the render stage
+ */
+typedef struct RenderMessageStruct
+{
+    RenderMessageType type;
+    std::string text;
+    std::vector<std::string> lines;
+    int frameIndex;
+    int scrollPages;
+    Deadline keyReadAt;
+} RenderMessage;
+
+/**
+ * One line of a replay script: a command and when to run it
+ */
+typedef struct ScriptLineStruct
+{
+    long long atMs;       // Virtual time from the start of the run; lines never run before earlier ones
+    std::string command;  // Empty for a line that only waits until atMs
+} ScriptLine;
+
+/**
+ * ConsoleController - Owns the handlers and runs them as a three-stage pipeline
+ *
+ * input thread  -> key ring    -> logic thread (KeyboardHandler, CommandHandler, MarqueeLanes)
+ * logic thread  -> render ring -> render thread (DisplayHandler, the only one writing to the terminal)
+ *
+ * The shared state (isRunning, isAnimating, speed, gifFps, marqueeText) belongs to the
+ * logic stage; the render stage only sees what arrives in RenderMessages.
+ */
 class ConsoleController {
 private:
     // Shared state variables that all handlers will reference
     bool isRunning;
     bool isAnimating;
-    int speed;
+    double speed;  // Marquee milliseconds per column
     std::string marqueeText;
     
     // GIF animation variables
-    std::vector<std::vector<std::string>> gifFrames;
+    FramePack gifFrames;
     int currentGifFrame;
     bool isGifAnimating;
+    int gifFps;  // Set by set_gif_fps; 0 plays the GIF at its own frame delays
+    
+    // Console backend shared by the display and keyboard handlers
+    Terminal* terminal;
+    
+    // Workers that help draw large frames: the lanes on the logic stage, the screen sections on the render stage
+    ThreadPool* renderPool;
+    
+    // Pipeline rings and the signals that wake an idle stage
+    SpscRing<KeyEvent, KEY_QUEUE_SIZE> keyQueue;
+    SpscRing<RenderMessage, RENDER_QUEUE_SIZE> renderQueue;
+    WakeSignal logicWake;
+    WakeSignal renderWake;
+    std::atomic<bool> stopRequested;
+    
+    // Messages the render ring had no room for yet, owned by the logic stage
+    std::deque<RenderMessage> renderBacklog;
+    
+    // Keypress-to-echo latency: the logic stage notes when the keys of a batch were read,
+    // the render stage records how long it took until their echo was flushed
+    Deadline pendingKeyReadAt;
+    LatencyStats echoLatency;
+    
+    // Logic stage scheduling state; each animated section keeps its own tick grid
+    FixedStepClock marqueeClock;
+    FixedStepClock gifClock;
+    bool marqueeWasAnimating;  // Lets the logic stage see start_marquee and restart the marquee's clock
+    long long framesRendered;
+    
+    // Headless runs replace the wall clock with one that jumps straight to the next deadline
+    bool useVirtualClock;
+    Deadline virtualNow;
+    std::vector<double> frameTimes;  // Wall time each headless frame took to produce, in microseconds
     
     // Handler instances
     CommandHandler* commandHandler;
     DisplayHandler* displayHandler;
     KeyboardHandler* keyboardHandler;
-    MarqueeLogicHandler* marqueeLogicHandler;
+    MarqueeLanes* marqueeLanes;
+    ControlSocketHandler* controlSocket;  // nullptr unless enableControlSocket() succeeded
     
 public:
-    ConsoleController() {
+    /**
+     * Constructor for ConsoleController
+     * @param terminal Console backend to run on, owned by the controller; nullptr for the platform default
+     * @param renderThreads Threads that help draw large frames; -1 for one less than the number of cores
+     */
+    ConsoleController(Terminal* terminal = nullptr, int renderThreads = -1) {
         // Initialize shared state
         isRunning = true;
         isAnimating = false;
@@ -37,12 +141,30 @@ public:
         // Initialize GIF animation variables
         currentGifFrame = 0;
         isGifAnimating = true;
+        gifFps = 0;
+        marqueeWasAnimating = false;
+        
+        stopRequested = false;
+        pendingKeyReadAt = NO_DEADLINE;
+        framesRendered = 0;
+        useVirtualClock = false;
+        
+        // Load the ASCII art font once; the display and the marquee share it
+        std::shared_ptr<const FileReader> font = FontCache::get();
+        
+        controlSocket = nullptr;
+        renderPool = new ThreadPool(renderThreads);
         
         // Initialize handlers with shared state pointers
-        commandHandler = new CommandHandler(&isRunning, &isAnimating, &speed, &marqueeText);
-        displayHandler = new DisplayHandler(&isRunning, &isAnimating, &speed, &marqueeText);
+        this->terminal = terminal ? terminal : createTerminal();
+        commandHandler = new CommandHandler(&isRunning, &isAnimating, &speed, &marqueeText, &gifFps);
+        displayHandler = new DisplayHandler(this->terminal, font);
         keyboardHandler = new KeyboardHandler(&isRunning, &isAnimating, &speed, &marqueeText);
-        marqueeLogicHandler = new MarqueeLogicHandler(80, 6); // 80 width, 6 height
+        
+        // Lanes span the marquee section inside its borders
+        int screenWidth, screenHeight;
+        this->terminal->getSize(screenWidth, screenHeight);
+        marqueeLanes = new MarqueeLanes(screenWidth - 2, font, &speed, &marqueeText);
         
         // Connect the handlers through callbacks
         connectHandlers();
@@ -52,137 +174,561 @@ public:
     }
     
     void loadGifFrames() {
-        const std::string framesPath = "utils/data/ascii_frames/";
-        
-        // Load frames frame_01.txt through frame_93.txt
-        for (int i = 1; i <= 93; i++) {
-            std::string filename = framesPath + "frame_" + std::string(2 - std::to_string(i).length(), '0') + std::to_string(i) + ".txt";
-            std::ifstream file(filename);
-            
-            if (file.is_open()) {
-                std::vector<std::string> frame;
-                std::string line;
-                
-                while (std::getline(file, line)) {
-                    frame.push_back(line);
-                }
-                
-                if (!frame.empty()) {
-                    gifFrames.push_back(frame);
-                }
-                
-                file.close();
-            }
+        // Map the packed frames (see utils/data/pack_frames.py); fall back to the loose text frames
+        if (!gifFrames.open(FRAME_PACK_FILE)) {
+            gifFrames.loadDirectory("utils/data/ascii_frames/");
         }
         
-        // If frames loaded successfully, start the GIF
+        // If frames loaded successfully, start the GIF from its keyframe
         if (!gifFrames.empty() && displayHandler) {
-            displayHandler->updateGifFrame(gifFrames[0]);
+            displayHandler->updateGifFrame(gifFrames.getKeyframe());
         }
     }
     
+    /**
+     * Gets how long the current GIF frame stays on screen
+     * @return 1/gifFps if set_gif_fps chose a rate, else the frame delay from the pack,
+     *         or the console speed (at most one frame per MIN_FRAME_MS) when the pack has none
+     */
+    std::chrono::nanoseconds gifFramePeriod() {
+        if (gifFps > 0) {
+            return std::chrono::nanoseconds(1000000000LL / gifFps);
+        }
+        int delay = gifFrames.getDelay(currentGifFrame);
+        if (delay > 0) {
+            return std::chrono::milliseconds(delay);
+        }
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::milli>(std::max(speed, (double)MIN_FRAME_MS)));
+    }
+    
     ~ConsoleController() {
         // Clean up handler instances
         delete commandHandler;
         delete displayHandler;
         delete keyboardHandler;
-        delete marqueeLogicHandler;
+        delete marqueeLanes;
+        delete controlSocket;
+        delete terminal;
+        delete renderPool;
     }
     
     void connectHandlers() {
         // Connect KeyboardHandler to CommandHandler
         // KeyboardHandler will call CommandHandler's enqueueCommand when user presses Enter
         keyboardHandler->connectHandler([this](const std::string& command) {
-            commandHandler->enqueueCommand(command);
+            if (!commandHandler->enqueueCommand(command)) {
+                RenderMessage message;
+                message.type = RENDER_CONSOLE_OUTPUT;
+                message.lines = {"Error: Command queue is full, '" + command + "' was dropped."};
+                publish(message);
+            }
         });
         
-        // Connect KeyboardHandler to DisplayHandler for real-time input display
+        // Connect KeyboardHandler to the render stage for real-time input display
         keyboardHandler->connectInputDisplay([this](const std::string& currentInput) {
-            displayHandler->updateInputLine(currentInput);
+            RenderMessage message;
+            message.type = RENDER_INPUT_LINE;
+            message.text = currentInput;
+            message.keyReadAt = pendingKeyReadAt;
+            publish(message);
         });
-
-        // Connect CommandHandler to MarqueeLogicHandler for text changes
+        
+        // Connect KeyboardHandler to the render stage for messages printed while typing
+        keyboardHandler->connectConsoleOutput([this](const std::string& text) {
+            RenderMessage message;
+            message.type = RENDER_CONSOLE_OUTPUT;
+            message.lines = {text};
+            publish(message);
+        });
+        
+        // Connect KeyboardHandler's PageUp/PageDown to the text console scrollback
+        keyboardHandler->connectScroll([this](int pages) {
+            RenderMessage message;
+            message.type = RENDER_SCROLL;
+            message.scrollPages = pages;
+            publish(message);
+        });
+        
+        // Responses to commands from control socket clients go back to the client
+        commandHandler->connectResponseRouter([this](int origin, const std::vector<std::string>& response) {
+            if (controlSocket) {
+                controlSocket->sendReply(origin, response);
+            }
+        });
+        
+        // The status command also reports how quickly typed keys are echoed
+        commandHandler->connectStatusReport([this]() {
+            return "echo latency: " + echoLatency.summary();
+        });
+        
+        // Connect CommandHandler to the main marquee lane for text changes
         commandHandler->connectMarqueeTextChange([this](const std::string& newText) {
-            marqueeLogicHandler->setText(newText);
+            marqueeLanes->setMainText(newText);
+        });
+        
+        // Streamed text goes to the main lane, which reads it a window at a time
+        commandHandler->connectTextSource([this](const std::string& path) {
+            return marqueeLanes->setMainTextSource(path);
         });
         
-        // Set up the marquee logic handler with initial text and speed
-        marqueeLogicHandler->setText(marqueeText);
-        marqueeLogicHandler->setAnimationSpeed(speed);
-        marqueeLogicHandler->initialize();
-        marqueeLogicHandler->startScrolling();
+        // The lane command runs on the logic stage, like every other command
+        commandHandler->connectLaneCommand([this](const std::vector<std::string_view>& arguments) {
+            return marqueeLanes->handleCommand(arguments, now());
+        });
+        
+        // Commands apply in order: a set_text earlier in the batch must not override the main lane's new text or source
+        marqueeLanes->connectMainTextChange([this]() {
+            commandHandler->cancelPendingTextChange();
+        });
         
-        // Get initial marquee display and send to DisplayHandler
-        std::vector<std::string> initialMarqueeDisplay = marqueeLogicHandler->getCurrentDisplay();
-        displayHandler->updateMarqueeDisplay(initialMarqueeDisplay);
+        // DisplayHandler draws whichever band of lanes was published last
+        displayHandler->connectMarqueeFrames(&marqueeLanes->getBand());
+        
+        // Both stages split large frames over the same pool; each waits only for its own parts
+        displayHandler->connectRenderPool(renderPool);
+        marqueeLanes->connectRenderPool(renderPool);
     }
     
+    /**
+     * Accepts commands from other processes on a UNIX-domain socket while the console runs
+     * @param path Filesystem path of the socket
+     * @return False if the socket could not be opened; errno tells why
+     */
+    bool enableControlSocket(const std::string& path) {
+        ControlSocketHandler* socket = new ControlSocketHandler(commandHandler);
+        if (!socket->open(path)) {
+            int error = errno;
+            delete socket;
+            errno = error;
+            return false;
+        }
+        
+        // Queued commands wake the logic stage like keys do
+        socket->connectCommandQueued([this]() {
+            logicWake.notify();
+        });
+        
+        controlSocket = socket;
+        return true;
+    }
+    
+    /**
+     * Runs the interactive console until the user exits.
+     * Input, logic and the control socket get their own threads; this thread becomes the render stage.
+     */
     void start() {
         // Initialize the display by clearing screen and drawing initial layout
         displayHandler->displayWelcome();
+        resetAnimationClocks();
         
-        bool needsDisplayUpdate = false;
-        auto lastMarqueeUpdate = std::chrono::steady_clock::now();
-        auto lastGifUpdate = std::chrono::steady_clock::now();
-        int marqueePosition = 0;
+        std::thread inputThread(&ConsoleController::runInputStage, this);
+        std::thread logicThread(&ConsoleController::runLogicStage, this);
+        std::thread controlThread;
+        if (controlSocket) {
+            controlThread = std::thread(&ControlSocketHandler::run, controlSocket);
+        }
         
-        // Main application loop
-        while (isRunning) {
-            // Process keyboard input (non-blocking)
-            keyboardHandler->pollKeyboard();
-            keyboardHandler->processBuffer();
+        runRenderStage();
+        
+        logicThread.join();
+        inputThread.join();
+        
+        // The input stage is gone; the exit screen's wait for a key must block again
+        terminal->resetWait();
+        if (controlThread.joinable()) {
+            // The logic stage has finished, so this thread may hand over the responses it left behind
+            controlSocket->flushReplies();
+            controlSocket->stop();
+            controlThread.join();
+        }
+        
+        // Show exit message
+        displayHandler->displayExit();
+    }
+    
+    /**
+     * Renders frames as fast as possible on a virtual clock, for benchmarks and golden-frame tests.
+     * Meant to be used with an OffscreenTerminal; the marquee is started automatically.
+     * The logic and render stages take turns on the calling thread, so runs are deterministic.
+     * @param frameCount Number of frames to render
+     * @param onFrame Called after each rendered frame with its 1-based number
+     * @param setupCommands Commands run before the first frame, e.g. to add lanes; their responses are dropped
+     */
+    void runHeadless(long long frameCount, std::function<void(long long)> onFrame = nullptr,
+                     const std::vector<std::string>& setupCommands = {}) {
+        useVirtualClock = true;
+        virtualNow = std::chrono::steady_clock::now();
+        isAnimating = true;
+        
+        for (const std::string& command : setupCommands) {
+            commandHandler->parseInput(command);
+        }
+        
+        displayHandler->displayWelcome();
+        resetAnimationClocks();
+        
+        while (isRunning && framesRendered < frameCount) {
+            Deadline deadline = headlessStep(onFrame);
             
-            // Process any queued commands
-            std::vector<std::string> commandResponses = commandHandler->processNextCommand();
-            if (!commandResponses.empty()) {
-                // Display command responses in the console area
-                displayHandler->displayCommandResponse(commandResponses);
-                needsDisplayUpdate = true;
+            // Nothing left to animate, so no further frame would ever be drawn
+            if (deadline == NO_DEADLINE) {
+                break;
             }
-            
-            // Update marquee animation if enabled (throttled)
-            if (isAnimating) {
-                auto now = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastMarqueeUpdate);
-                
-                if (elapsed.count() >= speed) {
-                    // Update MarqueeLogicHandler's animation speed and process
-                    marqueeLogicHandler->setAnimationSpeed(speed);
-                    marqueeLogicHandler->process();
-                    
-                    // Get the current display from MarqueeLogicHandler and send to DisplayHandler
-                    std::vector<std::string> marqueeDisplay = marqueeLogicHandler->getCurrentDisplay();
-                    displayHandler->updateMarqueeDisplay(marqueeDisplay);
-                    
-                    lastMarqueeUpdate = now;
-                    needsDisplayUpdate = true;
+            virtualNow = std::max(virtualNow, deadline);
+        }
+    }
+    
+    /**
+     * Replays a command script on the virtual clock, the same way runHeadless() renders.
+     * Each command goes through the command queue and CommandHandler::parseInput like a typed one;
+     * commands that are due together are queued as one batch. The marquee only moves if the script
+     * starts it, and virtual time only passes up to the last line's timestamp.
+     * @param script Lines to run, in order
+     * @param onFrame Called after each rendered frame with its 1-based number
+     * @return Number of commands queued before the script ended or ran exit
+     */
+    long long runScript(const std::vector<ScriptLine>& script, std::function<void(long long)> onFrame = nullptr) {
+        useVirtualClock = true;
+        virtualNow = std::chrono::steady_clock::now();
+        Deadline begin = virtualNow;
+        
+        displayHandler->displayWelcome();
+        resetAnimationClocks();
+        
+        std::size_t next = 0;
+        long long commandsQueued = 0;
+        
+        while (isRunning) {
+            // Queue every line that is due, as far as the command queue has room
+            while (next < script.size() && begin + std::chrono::milliseconds(script[next].atMs) <= virtualNow &&
+                   commandHandler->getQueueSize() < COMMAND_QUEUE_SIZE) {
+                if (!script[next].command.empty()) {
+                    commandHandler->enqueueCommand(script[next].command);
+                    commandsQueued++;
                 }
+                next++;
             }
             
-            // Update GIF animation if enabled and frames are loaded (throttled)
-            if (isGifAnimating && !gifFrames.empty()) {
-                auto now = std::chrono::steady_clock::now();
-                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastGifUpdate);
-                
-                if (elapsed.count() >= speed) {
-                    currentGifFrame = (currentGifFrame + 1) % gifFrames.size();
-                    displayHandler->updateGifFrame(gifFrames[currentGifFrame]);
-                    lastGifUpdate = now;
-                    needsDisplayUpdate = true;
+            Deadline deadline = headlessStep(onFrame);
+            
+            if (next == script.size() && !commandHandler->hasCommandsInQueue()) {
+                break;
+            }
+            if (next < script.size()) {
+                deadline = std::min(deadline, begin + std::chrono::milliseconds(script[next].atMs));
+            }
+            virtualNow = std::max(virtualNow, deadline);
+        }
+        
+        return commandsQueued;
+    }
+    
+    long long getFramesRendered() const {
+        return framesRendered;
+    }
+    
+    /**
+     * Gets how many threads help draw large frames, besides the stage drawing them
+     */
+    int getRenderThreads() const {
+        return renderPool->getThreadCount();
+    }
+    
+    /**
+     * Gets how long each frame of a headless run or script took to produce, in microseconds
+     */
+    const std::vector<double>& getFrameTimes() const {
+        return frameTimes;
+    }
+
+private:
+    /**
+     * Gets the current time from the wall clock, or from the virtual clock in headless runs
+     */
+    Deadline now() {
+        return useVirtualClock ? virtualNow : std::chrono::steady_clock::now();
+    }
+    
+    /**
+     * One logic and render pass of a headless run, timing the frame if one was drawn
+     * @param onFrame Called with the frame number if a frame was drawn
+     * @return The logic stage's next deadline
+     */
+    Deadline headlessStep(const std::function<void(long long)>& onFrame) {
+        long long framesBefore = framesRendered;
+        auto started = std::chrono::steady_clock::now();
+        
+        Deadline deadline = logicStep();
+        renderStep();
+        
+        if (framesRendered != framesBefore) {
+            frameTimes.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - started).count());
+            if (onFrame) {
+                onFrame(framesRendered);
+            }
+        }
+        return deadline;
+    }
+    
+    /**
+     * Schedules the first marquee and GIF ticks from the current time
+     */
+    void resetAnimationClocks() {
+        marqueeClock.reset(now());
+        gifClock.reset(now());
+    }
+    
+    /**
+     * Input stage: moves keys from the terminal into the key ring until shutdown or the end of input.
+     * Sleeps until a key arrives; the logic stage cancels the wait when it shuts down.
+     */
+    void runInputStage() {
+        while (!stopRequested) {
+            // stdin ended (e.g. < /dev/null), perhaps before this stage started: stop reading.
+            // Without a control socket no command can ever arrive again, so the console exits.
+            if (terminal->isInputClosed()) {
+                if (!controlSocket) {
+                    commandHandler->enqueueCommand("exit");
+                    logicWake.notify();
                 }
+                return;
             }
             
-            // Only update display when necessary
-            if (needsDisplayUpdate) {
-                displayHandler->updateDisplay();
-                needsDisplayUpdate = false;
+            if (!terminal->waitForInput(NO_DEADLINE)) {
+                continue;
             }
             
-            // Control the main loop speed - longer sleep since we're not updating constantly
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            KeyEvent key;
+            Deadline readAt = std::chrono::steady_clock::now();
+            while (terminal->readKey(key)) {
+                key.readAt = readAt;
+                // The logic stage only ever does in-memory work, so a full ring drains quickly
+                while (!keyQueue.tryPush(key) && !stopRequested) {
+                    std::this_thread::yield();
+                }
+            }
+            logicWake.notify();
+        }
+    }
+    
+    /**
+     * Logic stage: runs logicStep() whenever keys arrive or an animation tick is due
+     */
+    void runLogicStage() {
+        while (isRunning) {
+            Deadline deadline = logicStep();
+            
+            if (isRunning) {
+                logicWake.waitUntil(deadline);
+            }
         }
         
-        // Show exit message
-        displayHandler->displayExit();
+        // Tell the other stages to finish; the render stage stops once it reaches this message
+        stopRequested = true;
+        terminal->cancelWait();
+        RenderMessage message;
+        message.type = RENDER_SHUTDOWN;
+        publish(message);
+        while (!renderBacklog.empty()) {
+            std::this_thread::yield();
+            flushRenderBacklog();
+        }
+    }
+    
+    /**
+     * Render stage: applies updates to DisplayHandler until the logic stage shuts down
+     */
+    void runRenderStage() {
+        while (renderStep()) {
+            renderWake.waitUntil(NO_DEADLINE);
+        }
+    }
+    
+    /**
+     * Queues an update for the render stage. Never blocks: what the render ring
+     * cannot take yet waits in renderBacklog, in order.
+     * @param message Update to send, moved from
+     */
+    void publish(RenderMessage& message) {
+        renderBacklog.push_back(std::move(message));
+        flushRenderBacklog();
+    }
+    
+    /**
+     * Moves as much of renderBacklog into the render ring as fits, then wakes the render stage
+     */
+    void flushRenderBacklog() {
+        bool pushed = false;
+        while (!renderBacklog.empty() && renderQueue.tryPush(renderBacklog.front())) {
+            renderBacklog.pop_front();
+            pushed = true;
+        }
+        
+        if (pushed) {
+            renderWake.notify();
+        }
+    }
+    
+    /**
+     * One pass of the logic stage: keys, queued commands and due animation ticks
+     * @return When the next pass is needed, NO_DEADLINE if only input can change anything
+     */
+    Deadline logicStep() {
+        // Process the keys the input stage has read; the input line is echoed once for all of them
+        KeyEvent key;
+        while (keyQueue.tryPop(key)) {
+            pendingKeyReadAt = std::min(pendingKeyReadAt, key.readAt);
+            keyboardHandler->queueKey(key);
+        }
+        keyboardHandler->processBuffer();
+        pendingKeyReadAt = NO_DEADLINE;
+        
+        // Process every queued command as one batch, drawn with a single redraw
+        std::vector<std::string> commandResponses = commandHandler->processCommandBatch();
+        if (!commandResponses.empty()) {
+            // Display command responses in the console area
+            RenderMessage message;
+            message.type = RENDER_CONSOLE_OUTPUT;
+            message.lines = std::move(commandResponses);
+            publish(message);
+        }
+        
+        flushRenderBacklog();
+        if (controlSocket) {
+            controlSocket->flushReplies();
+        }
+        
+        // While the render stage is behind, animation frames are skipped rather than queued
+        bool renderCaughtUp = renderBacklog.empty();
+        
+        Deadline current = now();
+        
+        // One marquee frame per column of the fastest lane, unless columns go by faster than frames can be useful
+        auto period = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::duration<double, std::milli>(std::max(marqueeLanes->getFastestSpeed(), (double)MIN_FRAME_MS)));
+        
+        // A new speed takes effect from this moment; the text keeps its place
+        if (isAnimating) {
+            marqueeLanes->setMainSpeed(speed, current);
+        }
+        
+        // Update marquee animation if enabled and its tick is due
+        bool marqueeDrawn = false;
+        if (isAnimating && !marqueeWasAnimating) {
+            // Just started: scroll on from here, first frame one period later
+            marqueeLanes->resume(current);
+            marqueeClock.reset(current + period);
+        } else if (isAnimating && marqueeClock.isDue(current)) {
+            // The position follows elapsed time, so missed ticks need no making up: one update
+            // puts the text where it belongs, and a render stage that is behind just drops frames
+            marqueeLanes->process(current);
+            marqueeClock.step(period);
+            marqueeClock.skipMissed(current, period);
+            marqueeDrawn = true;
+        } else if (marqueeLanes->hasChanges()) {
+            // A lane was added, removed or changed between ticks (or while stopped): show it now
+            marqueeLanes->redraw();
+            marqueeDrawn = true;
+        }
+        
+        // The band itself goes through the triple buffer; only wake the render stage here
+        if (marqueeDrawn && renderCaughtUp) {
+            RenderMessage message;
+            message.type = RENDER_MARQUEE_FRAME;
+            publish(message);
+        }
+        marqueeWasAnimating = isAnimating;
+        
+        // Update GIF animation if enabled, frames are loaded and its tick is due.
+        // Frames are deltas, so every frame caught up on is sent; while the render stage
+        // is behind, the GIF holds its frame and the missed ticks are dropped instead.
+        bool gifActive = isGifAnimating && !gifFrames.empty();
+        if (gifActive && gifClock.isDue(current)) {
+            for (int ticks = 0; renderCaughtUp && ticks < MAX_CATCH_UP_TICKS && gifClock.isDue(current); ticks++) {
+                currentGifFrame = (currentGifFrame + 1) % gifFrames.getFrameCount();
+                
+                RenderMessage message;
+                message.type = RENDER_GIF_FRAME;
+                message.frameIndex = currentGifFrame;
+                publish(message);
+                
+                gifClock.step(gifFramePeriod());
+            }
+            gifClock.skipMissed(current, gifFramePeriod());
+        }
+        
+        // Sleep until the earliest animation tick or until input arrives;
+        // with nothing animating this blocks on input alone
+        Deadline deadline = NO_DEADLINE;
+        if (commandHandler->hasCommandsInQueue()) {
+            deadline = current;  // More commands are waiting, come straight back
+        } else {
+            if (isAnimating) deadline = std::min(deadline, marqueeClock.next());
+            if (gifActive) deadline = std::min(deadline, gifClock.next());
+            if (!renderBacklog.empty()) deadline = std::min(deadline, current + std::chrono::milliseconds(RENDER_RETRY_MS));
+            if (controlSocket && controlSocket->hasBackloggedReplies()) deadline = std::min(deadline, current + std::chrono::milliseconds(RENDER_RETRY_MS));
+        }
+        
+        return deadline;
+    }
+    
+    /**
+     * One pass of the render stage: applies every waiting update, then draws one frame
+     * @return False once the logic stage has shut down
+     */
+    bool renderStep() {
+        bool needsDisplayUpdate = false;
+        bool keepRunning = true;
+        
+        // Input lines are coalesced: only the newest is drawn, timed from the oldest key behind them
+        bool hasInputLine = false;
+        std::string inputLine;
+        Deadline inputKeyReadAt = NO_DEADLINE;
+        
+        RenderMessage message;
+        while (keepRunning && renderQueue.tryPop(message)) {
+            switch (message.type) {
+            case RENDER_INPUT_LINE:
+                hasInputLine = true;
+                inputLine.swap(message.text);
+                inputKeyReadAt = std::min(inputKeyReadAt, message.keyReadAt);
+                break;
+            case RENDER_CONSOLE_OUTPUT:
+                displayHandler->displayCommandResponse(message.lines);
+                needsDisplayUpdate = true;
+                break;
+            case RENDER_MARQUEE_FRAME:
+                needsDisplayUpdate = true;
+                break;
+            case RENDER_GIF_FRAME:
+                displayHandler->applyGifDelta(gifFrames, message.frameIndex);
+                needsDisplayUpdate = true;
+                break;
+            case RENDER_SCROLL:
+                displayHandler->scrollConsole(message.scrollPages);
+                break;
+            case RENDER_SHUTDOWN:
+                keepRunning = false;
+                break;
+            }
+        }
+        
+        // Only update display when necessary; a full update draws the input line too
+        if (needsDisplayUpdate) {
+            if (hasInputLine) {
+                displayHandler->setInputLine(inputLine);
+            }
+            displayHandler->updateDisplay();
+            framesRendered++;
+        } else if (hasInputLine) {
+            displayHandler->updateInputLine(inputLine);
+        }
+        
+        if (hasInputLine && inputKeyReadAt != NO_DEADLINE) {
+            echoLatency.record(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - inputKeyReadAt).count());
+        }
+        
+        return keepRunning;
     }
-};
\ No newline at end of file
+};
@@ -1,63 +1,192 @@
+#pragma once
+
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
-#include <queue>
-#include <mutex>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
 #include <functional>
+#include "../utils/MpscRing.cpp"
 
 #define DEBUG true
 
+// Commands that can wait in the queue at once (power of two); more are dropped
+#define COMMAND_QUEUE_SIZE 64
+
+// Width of the usage column in the help listing
+#define HELP_USAGE_WIDTH 19
+
+// Origin of commands typed at the console; other producers use their own ids
+#define CONSOLE_ORIGIN 0
+
+// Highest frame rate set_gif_fps accepts
+#define MAX_GIF_FPS 240
+
+class CommandHandler;
+
+/**
+ * A tokenized command line; the views point into the line being executed
+ */
 typedef struct CommandStruct
 {
-    std::string command;
-    std::vector<std::string> arguments;
+    std::string_view command;
+    std::vector<std::string_view> arguments;
 } Command;
 
+/**
+ * A command waiting in the queue, with who sent it so the response can go back there
+ */
+typedef struct QueuedCommandStruct
+{
+    std::string text;
+    int origin;  // CONSOLE_ORIGIN or a control socket client id
+} QueuedCommand;
+
+/**
+ * One row of the command table: how to run a command and how to describe it
+ */
+typedef struct CommandEntryStruct
+{
+    std::string_view name;
+    std::vector<std::string> (CommandHandler::*run)(const Command& cmd);
+    int minArguments;
+    int maxArguments;             // -1 for no limit
+    std::string_view usage;       // Name and arguments, as shown in help and errors
+    std::string_view description; // Empty for aliases and commands left out of help
+} CommandEntry;
+
+/**
+ * Checks at compile time that a command table is in name order
+ */
+constexpr bool isSortedByName(const CommandEntry* table, int count)
+{
+    for (int i = 1; i < count; i++)
+    {
+        if (!(table[i - 1].name < table[i].name))
+            return false;
+    }
+    return true;
+}
+
 class CommandHandler
 {
 public:
     bool *isRunning;
     bool *isAnimating;
-    int *speed;
+    double *speed;
     std::string *marqueeText;
+    int *gifFps;
 
-    CommandHandler(bool *isRunning, bool *isAnimating, int *speed, std::string *marqueeText)
+    CommandHandler(bool *isRunning, bool *isAnimating, double *speed, std::string *marqueeText, int *gifFps)
     {
         this->isRunning = isRunning;
         this->isAnimating = isAnimating;
         this->speed = speed;
         this->marqueeText = marqueeText;
+        this->gifFps = gifFps;
+        this->droppedCommands = 0;
+        this->peakQueueSize = 0;
+        this->deferTextChange = false;
+        this->pendingTextChange = false;
     }
 
     /**
      * Adds a command string to the processing queue (Producer function)
-     * This function is called by the KeyboardHandler via callback
+     * Safe to call from any thread; never blocks
      * @param commandString The command string to be queued for processing
+     * @param origin Who sent the command; responses to anyone but the console go to the response router
+     * @return False if the queue was full and the command was not queued
      */
-    void enqueueCommand(const std::string& commandString)
+    bool enqueueCommand(std::string_view commandString, int origin = CONSOLE_ORIGIN)
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        commandQueue.push(commandString);
+        bool queued = commandQueue.tryPushWith([&](QueuedCommand& slot) {
+            slot.text.assign(commandString.data(), commandString.length());
+            slot.origin = origin;
+        });
+
+        if (!queued)
+        {
+            // Other origins hold on to the command and retry, so only console commands are lost
+            if (origin == CONSOLE_ORIGIN)
+            {
+                droppedCommands.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        }
+
+        // Remember the deepest the queue has been, for status
+        std::size_t depth = commandQueue.size();
+        std::size_t peak = peakQueueSize.load(std::memory_order_relaxed);
+        while (depth > peak && !peakQueueSize.compare_exchange_weak(peak, depth, std::memory_order_relaxed))
+        {
+        }
+        return true;
     }
 
     /**
      * Processes the next command in the queue (Consumer function)
-     * @return Vector of response messages, empty if no commands in queue
+     * Must only be called from one thread; the command runs outside any lock
+     * @return Vector of response messages for the console, empty if no commands in queue
      */
     std::vector<std::string> processNextCommand()
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
+        std::vector<std::string> responses;
+        
+        if (commandQueue.tryPop(currentCommand))
+        {
+            runCurrentCommand(responses);
+        }
+        
+        return responses;
+    }
+
+    /**
+     * Runs every queued command as one batch (Consumer function)
+     * Commands execute in order, but re-rendering the marquee text is deferred to the end
+     * of the batch, so only the last of several set_text commands pays for it
+     * @return Console responses of all commands in order, starting with CLEAR_CONSOLE if one of them cleared the console
+     */
+    std::vector<std::string> processCommandBatch()
+    {
+        std::vector<std::string> responses;
+        
+        deferTextChange = true;
         
-        if (commandQueue.empty())
+        // Bounded so producers refilling the queue cannot hold up the animation
+        for (int i = 0; i < COMMAND_QUEUE_SIZE && *isRunning; i++)
         {
-            return {}; // No commands to process
+            if (!commandQueue.tryPop(currentCommand))
+            {
+                break;
+            }
+            
+            runCurrentCommand(responses);
         }
         
-        std::string commandString = commandQueue.front();
-        commandQueue.pop();
+        deferTextChange = false;
+        
+        if (pendingTextChange)
+        {
+            pendingTextChange = false;
+            if (marqueeTextChangeCallback) {
+                marqueeTextChangeCallback(*this->marqueeText);
+            }
+        }
         
-        // Parse and execute the command
-        return parseInput(commandString);
+        return responses;
+    }
+
+    /**
+     * Drops a set_text change still waiting for the end of the batch. Called when the main
+     * lane's text is changed another way, so an earlier set_text does not undo it.
+     */
+    void cancelPendingTextChange()
+    {
+        pendingTextChange = false;
     }
 
     /**
@@ -66,7 +195,6 @@ public:
      */
     bool hasCommandsInQueue()
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
         return !commandQueue.empty();
     }
 
@@ -76,10 +204,25 @@ public:
      */
     std::size_t getQueueSize()
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
         return commandQueue.size();
     }
 
+    /**
+     * Gets how many commands were dropped because the queue was full
+     */
+    std::size_t getDroppedCount()
+    {
+        return droppedCommands.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Gets the largest number of commands that have been waiting at once
+     */
+    std::size_t getPeakQueueSize()
+    {
+        return peakQueueSize.load(std::memory_order_relaxed);
+    }
+
     /**
      * Gets a callback function that can be used by KeyboardHandler
      * to enqueue commands. This enables the producer-consumer pattern.
@@ -92,6 +235,15 @@ public:
         };
     }
 
+    /**
+     * Connects the callback that delivers responses to commands not typed at the console
+     * @param callback Called with the command's origin and its response lines
+     */
+    void connectResponseRouter(std::function<void(int, const std::vector<std::string>&)> callback)
+    {
+        responseRouter = callback;
+    }
+
     /**
      * Connects a callback that will be called when marquee text changes
      * @param callback Function to call when text changes
@@ -101,130 +253,233 @@ public:
         marqueeTextChangeCallback = callback;
     }
 
-    std::vector<std::string> parseInput(std::string input)
+    /**
+     * Connects the callback that streams the marquee text from a file or named pipe
+     * @param callback Called with the path; returns the response line
+     */
+    void connectTextSource(std::function<std::string(const std::string&)> callback)
+    {
+        textSourceCallback = callback;
+    }
+
+    /**
+     * Connects the callback that runs the lane command
+     * @param callback Called with the arguments after "lane"; returns the response lines
+     */
+    void connectLaneCommand(std::function<std::vector<std::string>(const std::vector<std::string_view>&)> callback)
+    {
+        laneCommandCallback = callback;
+    }
+
+    /**
+     * Connects a callback that adds a line to the status output
+     * @param callback Returns the extra line
+     */
+    void connectStatusReport(std::function<std::string()> callback)
     {
-        Command cmd = parseCommand(input);
-        std::vector<std::string> display = commandController(cmd.command, cmd.arguments);
+        statusReportCallback = callback;
+    }
 
-        return display;
+    /**
+     * Tokenizes and runs one command line
+     * @param input The command line
+     * @return vector of response messages
+     */
+    std::vector<std::string> parseInput(std::string_view input)
+    {
+        tokenize(input, parsedCommand);
+        return commandController(parsedCommand);
+    }
+
+    /**
+     * Lists the commands that start with a prefix, for tab completion
+     * @param prefix What has been typed so far
+     * @return Matching command names in alphabetical order
+     */
+    static std::vector<std::string_view> completeCommand(std::string_view prefix)
+    {
+        std::vector<std::string_view> matches;
+        const CommandEntry* table = commandTable();
+
+        for (int i = 0; i < COMMAND_COUNT; i++)
+        {
+            if (table[i].name.substr(0, prefix.length()) == prefix && isAvailable(table[i]))
+            {
+                matches.push_back(table[i].name);
+            }
+        }
+        return matches;
     }
 
 private:
     // Producer-Consumer pattern components
-    std::queue<std::string> commandQueue;  // Queue to store commands from KeyboardHandler
-    std::mutex queueMutex;           // Mutex for thread-safe queue operations
+    MpscRing<QueuedCommand, COMMAND_QUEUE_SIZE> commandQueue;  // Commands from the keyboard and other producers
+    QueuedCommand currentCommand;                            // Consumer's slot, swapped with the queue's on pop
+    std::atomic<std::size_t> droppedCommands;
+    std::atomic<std::size_t> peakQueueSize;
+    
+    // Set while processCommandBatch() runs; text changes are announced once at the end
+    bool deferTextChange;
+    bool pendingTextChange;
     
     // Callback for marquee text changes
     std::function<void(const std::string&)> marqueeTextChangeCallback;
     
+    // Callback for responses to commands from other origins
+    std::function<void(int, const std::vector<std::string>&)> responseRouter;
+    
+    // Callback for an extra line of status output
+    std::function<std::string()> statusReportCallback;
+    
+    // Callback that streams the marquee text from a file
+    std::function<std::string(const std::string&)> textSourceCallback;
+    
+    // Callback that manages marquee lanes
+    std::function<std::vector<std::string>(const std::vector<std::string_view>&)> laneCommandCallback;
+    
+    // Tokens of the command being executed; reused so parsing does not allocate
+    Command parsedCommand;
+    
+    static constexpr int COMMAND_COUNT = 13;
+    
     /**
-     * Splits the input string into a vector of arguments based on spaces.
-     * @param input The input string to split.
-     * @return A vector of arguments.
+     * Gets the command table, sorted by name so lookups can binary search it
+     * @return COMMAND_COUNT entries
      */
-    Command parseCommand(std::string input)
+    static const CommandEntry* commandTable()
     {
-        std::string command = "";
-        Command cmd;
-        cmd.command = "";
-        cmd.arguments = {};
-
-        for (int i = 0; i < input.length(); i++)
+        static constexpr CommandEntry table[COMMAND_COUNT] = {
+            {"clear", &CommandHandler::runClear, 0, 0, "clear", "Clear the console screen"},
+            {"cls", &CommandHandler::runClear, 0, 0, "cls", ""},
+            {"exit", &CommandHandler::runExit, 0, 0, "exit", "Exit the program"},
+            {"help", &CommandHandler::runHelp, 0, 0, "help", "Show this help message"},
+            {"lane", &CommandHandler::runLane, 0, -1, "lane <action> ...", "Add, change or remove marquee lanes"},
+            {"set_gif_fps", &CommandHandler::runSetGifFps, 1, 1, "set_gif_fps <fps>", "Set the GIF frame rate (0 for its own timing)"},
+            {"set_speed", &CommandHandler::runSetSpeed, 1, 1, "set_speed <value>", "Set the speed of the marquee animation"},
+            {"set_text", &CommandHandler::runSetText, 1, -1, "set_text <text>", "Set the text to display in the marquee"},
+            {"set_text_source", &CommandHandler::runSetTextSource, 1, -1, "set_text_source <path>", "Stream the marquee text from a file or named pipe"},
+            {"speed", &CommandHandler::runSetSpeed, 1, 1, "speed <value>", ""},
+            {"start_marquee", &CommandHandler::runStartMarquee, 0, 0, "start_marquee", "Start the marquee animation"},
+            {"status", &CommandHandler::runStatus, 0, 0, "status", ""},
+            {"stop_marquee", &CommandHandler::runStopMarquee, 0, 0, "stop_marquee", "Stop the marquee animation"},
+        };
+        static_assert(isSortedByName(table, COMMAND_COUNT), "Command table must be sorted by name");
+        
+        return table;
+    }
+    
+    /**
+     * Debug-only commands are in the table but unavailable in release builds
+     */
+    static bool isAvailable(const CommandEntry& entry)
+    {
+        return DEBUG || entry.name != "status";
+    }
+    
+    /**
+     * Finds a command by name
+     * @return The table entry, or nullptr for an unknown command
+     */
+    static const CommandEntry* findCommand(std::string_view name)
+    {
+        const CommandEntry* table = commandTable();
+        int low = 0;
+        int high = COMMAND_COUNT - 1;
+        
+        while (low <= high)
         {
-            if (input[i] == ' ')
+            int middle = (low + high) / 2;
+            if (table[middle].name == name)
+                return isAvailable(table[middle]) ? &table[middle] : nullptr;
+            if (table[middle].name < name)
+                low = middle + 1;
+            else
+                high = middle - 1;
+        }
+        return nullptr;
+    }
+    
+    /**
+     * Runs the command in currentCommand and sends its response to whoever sent it
+     * @param consoleResponses Receives the lines meant for the console
+     */
+    void runCurrentCommand(std::vector<std::string>& consoleResponses)
+    {
+        std::vector<std::string> response = parseInput(currentCommand.text);
+        bool cleared = !response.empty() && response[0] == "CLEAR_CONSOLE";
+        
+        if (currentCommand.origin != CONSOLE_ORIGIN)
+        {
+            // The sender gets the response; a clear still clears the console
+            if (responseRouter)
             {
-                if (!command.empty())
-                {
-                    if (cmd.command.empty())
-                    {
-                        cmd.command = command;
-                    }
-                    else
-                    {
-                        cmd.arguments.push_back(command);
-                    }
-                    command = "";
-                }
+                responseRouter(currentCommand.origin, cleared ? std::vector<std::string>{"Console cleared."} : response);
             }
-            else
+            if (!cleared)
             {
-                command += input[i];
+                return;
             }
         }
-        // Handle last token
-        if (!command.empty())
+        
+        if (cleared)
+        {
+            // Nothing printed before a clear would stay on screen
+            consoleResponses = {"CLEAR_CONSOLE"};
+        }
+        else
         {
+            consoleResponses.insert(consoleResponses.end(), response.begin(), response.end());
+        }
+    }
+
+    /**
+     * Splits the input into space-separated tokens without copying them.
+     * @param input The command line; the tokens point into it.
+     * @param cmd Receives the command name and its arguments.
+     */
+    void tokenize(std::string_view input, Command& cmd)
+    {
+        cmd.command = std::string_view();
+        cmd.arguments.clear();
+
+        std::size_t position = input.find_first_not_of(' ');
+        while (position != std::string_view::npos)
+        {
+            std::size_t end = input.find(' ', position);
+            std::string_view token = input.substr(position, end == std::string_view::npos ? end : end - position);
+
             if (cmd.command.empty())
             {
-                cmd.command = command;
+                cmd.command = token;
             }
             else
             {
-                cmd.arguments.push_back(command);
+                cmd.arguments.push_back(token);
             }
-        }
 
-        return cmd;
+            position = input.find_first_not_of(' ', end == std::string_view::npos ? input.length() : end);
+        }
     }
 
     /**
-     * Handles command execution based on the input command and its arguments.
-     * @param command The command to execute.
-     * @param arguments The arguments associated with the command.
+     * Looks the command up in the command table, checks its arity and runs it.
+     * @param cmd The tokenized command.
      * @return vector of response messages. see indivudal functions for actual return types.
      */
-    std::vector<std::string> commandController(std::string command, const std::vector<std::string> &arguments = {})
+    std::vector<std::string> commandController(const Command& cmd)
     {
-        if (command == "")
+        if (cmd.command.empty())
             return {""};
-        else if (command == "help")
-            return this->getHelp();
-        else if (command == "start_marquee")
-        {
-            return {this->startMarquee()};
-        }
-        else if (command == "stop_marquee")
-            return {this->stopMarquee()};
-        else if (command == "set_text")
-        {
-            if (arguments.size() < 1)
-                return {"Error: set_text requires a text argument."};
-            else
-            {
-                std::string text = "";
-                for (std::size_t i = 0; i < arguments.size(); i++)
-                {
-                    if (i > 0) text += " ";
-                    text += arguments[i];
-                }
-                return {this->setText(text)};
-            }
-        }
-        else if (command == "set_speed" || command == "speed")
-        {
-            if (arguments.size() < 1)
-                return {"Error: set_speed requires an argument."};
-            else
-                try
-                {
-                    int speed = std::stoi(arguments[0]);
-                    return {this->setSpeed(speed)};
-                }
-                catch (const std::exception &e)
-                {
-                    return {"Error: Invalid speed value."};
-                }
-        }
-        else if (command == "clear" || command == "cls")
-        {
-            return {"CLEAR_CONSOLE"};
-        }
-        else if (command == "status" && DEBUG)
-            return {this->status()};
-        else if (command == "exit")
-            return {this->exitProgram()};
 
-        return {"Error: Unknown command '" + command + "'."};
+        const CommandEntry* entry = findCommand(cmd.command);
+        if (!entry)
+            return {"Error: Unknown command '" + std::string(cmd.command) + "'."};
+
+        int count = (int)cmd.arguments.size();
+        if (count < entry->minArguments || (entry->maxArguments >= 0 && count > entry->maxArguments))
+            return {"Error: Usage: " + std::string(entry->usage)};
+
+        return (this->*entry->run)(cmd);
     }
 
     /**
@@ -235,17 +490,112 @@ private:
     {
         std::vector<std::string> helpMessages;
         helpMessages.push_back("Available commands:");
-        helpMessages.push_back(" - help               Show this help message");
-        helpMessages.push_back(" - start_marquee      Start the marquee animation");
-        helpMessages.push_back(" - stop_marquee       Stop the marquee animation");
-        helpMessages.push_back(" - set_text <text>    Set the text to display in the marquee");
-        helpMessages.push_back(" - set_speed <value>  Set the speed of the marquee animation");
-        helpMessages.push_back(" - clear              Clear the console screen");
-        helpMessages.push_back(" - exit               Exit the program");
+
+        const CommandEntry* table = commandTable();
+        for (int i = 0; i < COMMAND_COUNT; i++)
+        {
+            if (table[i].description.empty())
+                continue;
+
+            std::string line = " - ";
+            line += table[i].usage;
+            line.append(std::max(1, HELP_USAGE_WIDTH - (int)table[i].usage.length()), ' ');
+            line += table[i].description;
+            helpMessages.push_back(line);
+        }
 
         return helpMessages;
     }
 
+    std::vector<std::string> runHelp(const Command&)
+    {
+        return this->getHelp();
+    }
+
+    std::vector<std::string> runStartMarquee(const Command&)
+    {
+        return {this->startMarquee()};
+    }
+
+    std::vector<std::string> runStopMarquee(const Command&)
+    {
+        return {this->stopMarquee()};
+    }
+
+    std::vector<std::string> runSetText(const Command& cmd)
+    {
+        // Arguments are rejoined with single spaces
+        std::string text;
+        for (std::size_t i = 0; i < cmd.arguments.size(); i++)
+        {
+            if (i > 0) text += ' ';
+            text += cmd.arguments[i];
+        }
+        return {this->setText(text)};
+    }
+
+    std::vector<std::string> runSetTextSource(const Command& cmd)
+    {
+        if (!textSourceCallback)
+            return {"Error: Text sources are not available."};
+
+        // Arguments are rejoined with single spaces, like set_text's
+        std::string path;
+        for (std::size_t i = 0; i < cmd.arguments.size(); i++)
+        {
+            if (i > 0) path += ' ';
+            path += cmd.arguments[i];
+        }
+
+        return {textSourceCallback(path)};
+    }
+
+    std::vector<std::string> runSetSpeed(const Command& cmd)
+    {
+        // strtod rather than from_chars, which not every supported compiler has for doubles
+        std::string argument(cmd.arguments[0]);
+        char* end = nullptr;
+        double speed = std::strtod(argument.c_str(), &end);
+        if (argument.empty() || *end != '\0' || !std::isfinite(speed))
+            return {"Error: Invalid speed value."};
+
+        return {this->setSpeed(speed)};
+    }
+
+    std::vector<std::string> runSetGifFps(const Command& cmd)
+    {
+        std::string_view argument = cmd.arguments[0];
+        int fps = 0;
+        auto result = std::from_chars(argument.data(), argument.data() + argument.length(), fps);
+        if (result.ec != std::errc() || result.ptr != argument.data() + argument.length() || fps < 0 || fps > MAX_GIF_FPS)
+            return {"Error: GIF frame rate must be 0 to " + std::to_string(MAX_GIF_FPS) + "."};
+
+        return {this->setGifFps(fps)};
+    }
+
+    std::vector<std::string> runLane(const Command& cmd)
+    {
+        if (!laneCommandCallback)
+            return {"Error: Marquee lanes are not available."};
+
+        return laneCommandCallback(cmd.arguments);
+    }
+
+    std::vector<std::string> runClear(const Command&)
+    {
+        return {"CLEAR_CONSOLE"};
+    }
+
+    std::vector<std::string> runStatus(const Command&)
+    {
+        return this->status();
+    }
+
+    std::vector<std::string> runExit(const Command&)
+    {
+        return {this->exitProgram()};
+    }
+
     /**
      * Starts the marquee animation by setting isAnimating to true.
      * @return message indicating the marquee has been started or was already running.
@@ -294,8 +644,10 @@ private:
         
         *this->marqueeText = text;
         
-        // Notify MarqueeLogicHandler of the text change
-        if (marqueeTextChangeCallback) {
+        // Notify MarqueeLogicHandler of the text change, once per batch when batching
+        if (deferTextChange) {
+            pendingTextChange = true;
+        } else if (marqueeTextChangeCallback) {
             marqueeTextChangeCallback(text);
         }
         
@@ -304,26 +656,63 @@ private:
 
     /**
      * Sets the speed of the marquee animation.
-     * @param speed The new speed value.
+     * @param speed Milliseconds per column; fractions are allowed (2.5 is 400 columns per second).
      * @return A message indicating the new speed.
      */
-    std::string setSpeed(int speed)
+    std::string setSpeed(double speed)
     {
         // Implementation to set speed
+        if (speed <= 0)
+            return "Error: Speed must be a positive number of milliseconds.";
+
         if (speed == *this->speed)
-            return "Marquee speed is already set to " + std::to_string(speed) + ".";
+            return "Marquee speed is already set to " + formatSpeed(speed) + ".";
 
         *this->speed = speed;
-        return "Marquee speed set to " + std::to_string(speed) + ".";
+        return "Marquee speed set to " + formatSpeed(speed) + ".";
     }
 
-    std::string status()
+    /**
+     * Formats a speed without trailing zeros, e.g. 100 or 2.5
+     */
+    static std::string formatSpeed(double speed)
+    {
+        std::ostringstream text;
+        text << speed;
+        return text.str();
+    }
+
+    /**
+     * Sets the GIF frame rate, independent of the marquee speed
+     * @param fps Frames per second, or 0 to use the frame delays stored with the GIF
+     * @return A message confirming the new frame rate
+     */
+    std::string setGifFps(int fps)
+    {
+        *this->gifFps = fps;
+        if (fps == 0)
+            return "GIF plays at its own frame timing.";
+        return "GIF frame rate set to " + std::to_string(fps) + " fps.";
+    }
+
+    std::vector<std::string> status()
     {
         std::string statusMessage;
         statusMessage += "isRunning: " + std::string(*this->isRunning ? "true" : "false") + ", ";
         statusMessage += "isAnimating: " + std::string(*this->isAnimating ? "true" : "false") + ", ";
-        statusMessage += "speed: " + std::to_string(*this->speed);
-        return statusMessage;
+        statusMessage += "speed: " + formatSpeed(*this->speed) + ", ";
+        statusMessage += "gif fps: " + (*this->gifFps > 0 ? std::to_string(*this->gifFps) : std::string("auto"));
+
+        std::string queueMessage;
+        queueMessage += "queue: " + std::to_string(getQueueSize()) + "/" + std::to_string(commandQueue.capacity()) + ", ";
+        queueMessage += "peak: " + std::to_string(getPeakQueueSize()) + ", ";
+        queueMessage += "dropped: " + std::to_string(getDroppedCount());
+
+        if (statusReportCallback)
+        {
+            return {statusMessage, queueMessage, statusReportCallback()};
+        }
+        return {statusMessage, queueMessage};
     }
 
     /**
@@ -0,0 +1,634 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <functional>
+#include <iterator>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include "CommandHandler.cpp"
+#include "../utils/SpscRing.cpp"
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <fcntl.h>
+#endif
+
+// Clients connected at once; further connections are closed straight away
+#define CONTROL_MAX_CLIENTS 64
+
+// Longest command line a client may send
+#define CONTROL_MAX_LINE 4096
+
+// Received bytes a client may have waiting before reading from it pauses
+#define CONTROL_MAX_INPUT (64 * 1024)
+
+// Unsent output a client may fall behind by before it is disconnected
+#define CONTROL_MAX_OUTPUT (1 << 20)
+
+// Responses waiting to be written back to clients (power of two)
+#define CONTROL_REPLY_QUEUE_SIZE 256
+
+// How soon to retry client lines that did not fit in the command queue
+#define CONTROL_RETRY_MS 1
+
+/**
+ * A command response on its way back to the client that sent the command
+ */
+typedef struct ControlReplyStruct
+{
+    int client;
+    std::vector<std::string> lines;
+} ControlReply;
+
+#ifdef __linux__
+
+/**
+ * ControlSocketHandler - UNIX-domain socket for driving the console from other processes
+ *
+ * Clients send newline-delimited commands, exactly as they would be typed.
+ * Each command is queued in CommandHandler with the client's id as its
+ * origin, and its response comes back as the response lines followed by
+ * an empty line. One thread runs all clients through epoll; run() is
+ * that thread's body. Responses are handed over from the logic stage
+ * through an SPSC ring and an eventfd.
+ */
+class ControlSocketHandler
+{
+private:
+    typedef struct ClientStruct
+    {
+        int fd;
+        std::string input;       // Received bytes not yet queued as commands
+        std::string output;      // Response bytes not yet written
+        int pendingReplies;      // Commands queued whose response has not arrived
+        bool readClosed;         // Client finished sending; close once everything is answered
+        uint32_t watchedEvents;  // What epoll currently reports for this client
+        bool broken;             // Failed or misbehaved; closed at the end of the pass
+    } Client;
+
+    // epoll tokens for the two descriptors that are not clients (client ids start at 1)
+    static const int LISTEN_TOKEN = -1;
+    static const int WAKE_TOKEN = -2;
+
+    CommandHandler* commandHandler;
+    std::string path;
+    int listenFd;
+    int epollFd;
+    int wakeFd;
+
+    std::unordered_map<int, Client> clients;  // Keyed by client id, never reused
+    int nextClientId;
+    std::size_t firstQueuedClient;            // Rotates, so no client is always queued first
+
+    // Responses from the logic stage; replyBacklog holds what the ring had no room for
+    SpscRing<ControlReply, CONTROL_REPLY_QUEUE_SIZE> replyQueue;
+    std::deque<ControlReply> replyBacklog;
+
+    std::atomic<bool> stopRequested;
+
+    // Called after commands were queued, to wake the logic stage
+    std::function<void()> commandQueuedCallback;
+
+public:
+    /**
+     * Constructor for ControlSocketHandler
+     * @param commandHandler Command queue that received commands go to
+     */
+    ControlSocketHandler(CommandHandler* commandHandler)
+    {
+        this->commandHandler = commandHandler;
+        listenFd = -1;
+        epollFd = -1;
+        wakeFd = -1;
+        nextClientId = 1;
+        firstQueuedClient = 0;
+        stopRequested = false;
+    }
+
+    ~ControlSocketHandler()
+    {
+        for (auto& entry : clients)
+        {
+            close(entry.second.fd);
+        }
+        if (listenFd >= 0)
+        {
+            close(listenFd);
+            unlink(path.c_str());
+        }
+        if (wakeFd >= 0) close(wakeFd);
+        if (epollFd >= 0) close(epollFd);
+    }
+
+    ControlSocketHandler(const ControlSocketHandler&) = delete;
+    ControlSocketHandler& operator=(const ControlSocketHandler&) = delete;
+
+    /**
+     * Creates the socket and starts listening. A stale socket file at the path is replaced.
+     * @param path Filesystem path of the socket
+     * @return False if the socket could not be set up; errno tells why
+     */
+    bool open(const std::string& path)
+    {
+        struct sockaddr_un address = {};
+        if (path.empty() || path.length() >= sizeof(address.sun_path))
+        {
+            errno = ENAMETOOLONG;
+            return false;
+        }
+
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.length() + 1);
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (epollFd < 0 || wakeFd < 0 || listenFd < 0)
+            return false;
+
+        // Only the owner may drive the console; the mask makes bind() create the socket that way,
+        // so it is never reachable with wider permissions
+        unlink(path.c_str());
+        mode_t previousMask = umask(S_IRWXG | S_IRWXO);
+        int bound = bind(listenFd, (struct sockaddr*)&address, sizeof(address));
+        umask(previousMask);
+        if (bound != 0)
+            return false;
+        this->path = path;
+
+        if (listen(listenFd, SOMAXCONN) != 0)
+            return false;
+
+        return watch(listenFd, LISTEN_TOKEN, EPOLLIN) && watch(wakeFd, WAKE_TOKEN, EPOLLIN);
+    }
+
+    /**
+     * Connects the callback run after commands were queued
+     */
+    void connectCommandQueued(std::function<void()> callback)
+    {
+        commandQueuedCallback = callback;
+    }
+
+    /**
+     * Serves clients until stop() is called (control thread)
+     */
+    void run()
+    {
+        bool retryInput = false;
+        struct epoll_event events[64];
+
+        while (!stopRequested)
+        {
+            int count = epoll_wait(epollFd, events, 64, retryInput ? CONTROL_RETRY_MS : -1);
+            if (count < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                int token = (int)(int64_t)events[i].data.u64;
+
+                if (token == LISTEN_TOKEN)
+                {
+                    acceptClients();
+                }
+                else if (token == WAKE_TOKEN)
+                {
+                    uint64_t value;
+                    while (read(wakeFd, &value, sizeof(value)) > 0)
+                    {
+                    }
+                }
+                else
+                {
+                    handleClientEvent(token, events[i].events);
+                }
+            }
+
+            deliverReplies();
+            retryInput = queueAllClientInput();
+            closeFinishedClients();
+        }
+
+        // Responses that arrived before stop(), such as the one to exit, still go out;
+        // best effort, since writeClient() never waits for a client to read
+        deliverReplies();
+    }
+
+    /**
+     * Makes run() return (any thread); responses already handed over are written first, as far as clients take them
+     */
+    void stop()
+    {
+        stopRequested = true;
+        wake();
+    }
+
+    /**
+     * Sends a command response back to its client (logic stage only). Never blocks;
+     * what the ring cannot take yet is kept and retried by flushReplies().
+     * @param client Client id the command came from
+     * @param lines Response lines
+     */
+    void sendReply(int client, const std::vector<std::string>& lines)
+    {
+        ControlReply reply;
+        reply.client = client;
+        reply.lines = lines;
+        replyBacklog.push_back(std::move(reply));
+        flushReplies();
+    }
+
+    /**
+     * Moves backlogged responses into the ring and wakes the control thread (logic stage only)
+     */
+    void flushReplies()
+    {
+        bool pushed = false;
+        while (!replyBacklog.empty() && replyQueue.tryPush(replyBacklog.front()))
+        {
+            replyBacklog.pop_front();
+            pushed = true;
+        }
+
+        if (pushed)
+        {
+            wake();
+        }
+    }
+
+    /**
+     * True while responses are waiting for room in the ring (logic stage only)
+     */
+    bool hasBackloggedReplies() const
+    {
+        return !replyBacklog.empty();
+    }
+
+private:
+    void wake()
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd, &one, sizeof(one));
+        (void)ignored;
+    }
+
+    bool watch(int fd, int token, uint32_t events)
+    {
+        struct epoll_event event = {};
+        event.events = events;
+        event.data.u64 = (uint64_t)(int64_t)token;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == 0;
+    }
+
+    /**
+     * Accepts every pending connection
+     */
+    void acceptClients()
+    {
+        for (;;)
+        {
+            int fd = accept4(listenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+
+            if (clients.size() >= CONTROL_MAX_CLIENTS)
+            {
+                close(fd);
+                continue;
+            }
+
+            int id = nextClientId++;
+            Client& client = clients[id];
+            client.fd = fd;
+            client.pendingReplies = 0;
+            client.readClosed = false;
+            client.watchedEvents = EPOLLIN | EPOLLRDHUP;
+            client.broken = false;
+
+            if (!watch(fd, id, EPOLLIN | EPOLLRDHUP))
+            {
+                closeClient(id);
+            }
+        }
+    }
+
+    /**
+     * Reads and writes for one client as epoll reported
+     */
+    void handleClientEvent(int id, uint32_t events)
+    {
+        auto found = clients.find(id);
+        if (found == clients.end() || found->second.broken)
+            return;
+        Client& client = found->second;
+
+        if (events & EPOLLERR)
+        {
+            client.broken = true;
+            return;
+        }
+
+        if (events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))
+        {
+            if (!readClient(id, client))
+                return;
+        }
+
+        if (events & EPOLLOUT)
+        {
+            writeClient(id, client);
+        }
+    }
+
+    /**
+     * Reads whatever the client has sent into its input buffer
+     * @return False if the client broke
+     */
+    bool readClient(int id, Client& client)
+    {
+        char bytes[4096];
+
+        // A full input buffer stops reading until the command queue takes some of it
+        while (!client.readClosed && client.input.length() < CONTROL_MAX_INPUT)
+        {
+            ssize_t count = read(client.fd, bytes, sizeof(bytes));
+            if (count > 0)
+            {
+                client.input.append(bytes, count);
+            }
+            else if (count == 0)
+            {
+                // Stop watching for input; the connection stays open for the responses
+                client.readClosed = true;
+            }
+            else
+            {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    break;
+                if (errno == EINTR)
+                    continue;
+                client.broken = true;
+                return false;
+            }
+        }
+
+        updateEvents(id, client);
+        return true;
+    }
+
+    /**
+     * Queues the complete lines of every client. Each pass starts one client further on and
+     * carries on past a client the queue filled up for, so a flooding client cannot starve the rest.
+     * @return True if some lines did not fit in the command queue and must be retried
+     */
+    bool queueAllClientInput()
+    {
+        if (clients.empty())
+            return false;
+
+        auto entry = clients.begin();
+        std::advance(entry, firstQueuedClient++ % clients.size());
+
+        bool retry = false;
+        for (std::size_t i = 0; i < clients.size(); i++)
+        {
+            if (!entry->second.broken && !queueClientInput(entry->first, entry->second))
+            {
+                retry = true;
+            }
+            if (++entry == clients.end())
+            {
+                entry = clients.begin();
+            }
+        }
+        return retry;
+    }
+
+    /**
+     * Closes clients that broke, and clients that hung up once everything they sent is answered
+     */
+    void closeFinishedClients()
+    {
+        std::vector<int> finished;
+
+        for (auto& entry : clients)
+        {
+            const Client& client = entry.second;
+            bool answered = client.readClosed && client.pendingReplies == 0 && client.output.empty() &&
+                            client.input.find('\n') == std::string::npos;
+
+            if (client.broken || answered)
+            {
+                finished.push_back(entry.first);
+            }
+        }
+
+        for (int id : finished)
+        {
+            closeClient(id);
+        }
+    }
+
+    /**
+     * Queues each complete line of a client's input as a command
+     * @return False if the command queue filled up before all lines were queued
+     */
+    bool queueClientInput(int id, Client& client)
+    {
+        std::size_t start = 0;
+        bool queuedAny = false;
+        bool queueFull = false;
+
+        for (;;)
+        {
+            std::size_t end = client.input.find('\n', start);
+            if (end == std::string::npos)
+                break;
+
+            std::string_view line(client.input.data() + start, end - start);
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.remove_suffix(1);
+            }
+
+            if (!commandHandler->enqueueCommand(line, id))
+            {
+                queueFull = true;
+                break;
+            }
+
+            client.pendingReplies++;
+            queuedAny = true;
+            start = end + 1;
+        }
+
+        client.input.erase(0, start);
+
+        // A line that never ends is refused rather than buffered forever
+        if (client.input.length() > CONTROL_MAX_LINE && client.input.find('\n') == std::string::npos)
+        {
+            client.input.clear();
+            appendReply(id, client, {"Error: Command is longer than " + std::to_string(CONTROL_MAX_LINE) + " bytes."});
+        }
+
+        if (queuedAny && commandQueuedCallback)
+        {
+            commandQueuedCallback();
+        }
+
+        updateEvents(id, client);
+
+        return !queueFull;
+    }
+
+    /**
+     * Moves responses from the logic stage into their clients' output
+     */
+    void deliverReplies()
+    {
+        ControlReply reply;
+        while (replyQueue.tryPop(reply))
+        {
+            auto found = clients.find(reply.client);
+            if (found == clients.end() || found->second.broken)
+                continue;  // Client left before its response was ready
+
+            found->second.pendingReplies--;
+            appendReply(reply.client, found->second, reply.lines);
+        }
+    }
+
+    /**
+     * Adds response lines and the terminating empty line to a client's output, then sends what it can
+     */
+    void appendReply(int id, Client& client, const std::vector<std::string>& lines)
+    {
+        for (const std::string& line : lines)
+        {
+            client.output += line;
+            client.output += '\n';
+        }
+        client.output += '\n';
+
+        writeClient(id, client);
+    }
+
+    /**
+     * Writes as much pending output as the socket takes
+     * @return False if the client broke
+     */
+    bool writeClient(int id, Client& client)
+    {
+        std::size_t sent = 0;
+        while (sent < client.output.length())
+        {
+            ssize_t count = send(client.fd, client.output.data() + sent, client.output.length() - sent, MSG_NOSIGNAL);
+            if (count > 0)
+            {
+                sent += count;
+            }
+            else if (count < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                break;
+            }
+            else
+            {
+                client.broken = true;
+                return false;
+            }
+        }
+        client.output.erase(0, sent);
+
+        // A client that stops reading is dropped instead of buffering without limit
+        if (client.output.length() > CONTROL_MAX_OUTPUT)
+        {
+            client.broken = true;
+            return false;
+        }
+
+        updateEvents(id, client);
+        return true;
+    }
+
+    /**
+     * Watches a client for input while it has room for more, and for writability while output waits
+     */
+    void updateEvents(int id, Client& client)
+    {
+        uint32_t wanted = 0;
+        if (!client.readClosed && client.input.length() < CONTROL_MAX_INPUT)
+        {
+            wanted |= EPOLLIN | EPOLLRDHUP;
+        }
+        if (!client.output.empty())
+        {
+            wanted |= EPOLLOUT;
+        }
+
+        if (wanted == client.watchedEvents)
+            return;
+
+        struct epoll_event event = {};
+        event.events = wanted;
+        event.data.u64 = (uint64_t)(int64_t)id;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+        client.watchedEvents = wanted;
+    }
+
+    void closeClient(int id)
+    {
+        auto found = clients.find(id);
+        if (found == clients.end())
+            return;
+
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, found->second.fd, NULL);
+        close(found->second.fd);
+        clients.erase(found);
+    }
+};
+
+#else
+
+/**
+ * ControlSocketHandler - Not available on this platform; open() always fails
+ */
+class ControlSocketHandler
+{
+public:
+    ControlSocketHandler(CommandHandler*)
+    {
+    }
+
+    bool open(const std::string&)
+    {
+        errno = ENOSYS;
+        return false;
+    }
+
+    void connectCommandQueued(std::function<void()>) {}
+    void run() {}
+    void stop() {}
+    void sendReply(int, const std::vector<std::string>&) {}
+    void flushReplies() {}
+    bool hasBackloggedReplies() const { return false; }
+};
+
+#endif
@@ -1,222 +1,97 @@
-#include <iostream>
 #include <string>
 #include <vector>
-#include <windows.h>
 #include <iomanip>
-#include <conio.h>
 #include <fstream>
 #include <map>
+#include "../utils/FrameBuffer.cpp"
+#include "../utils/Terminal.cpp"
+#include "../utils/FramePack.cpp"
+#include "../utils/TripleBuffer.cpp"
+#include "../utils/RingBuffer.cpp"
+#include "../utils/ThreadPool.cpp"
+#include "FontCache.cpp"
 
-#define MAX_ASCII_ART_HEIGHT 6
+// Text console lines kept for scrolling back with PageUp; older lines are dropped
+#ifndef SCROLLBACK_LINES
+#define SCROLLBACK_LINES 100000
+#endif
 
-/**
- * Simple ASCII Art Manager for DisplayHandler
- */
-class SimpleASCIIArt
-{
-private:
-    std::map<char, std::vector<std::string>> charMap;
-    int artHeight;
-    
-public:
-    SimpleASCIIArt()
-    {
-        artHeight = MAX_ASCII_ART_HEIGHT;
-        loadBasicCharacters();
-    }
-    
-    void loadBasicCharacters()
-    {
-        // Load some basic characters from files
-        std::string chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789";
-        for (char c : chars)
-        {
-            loadCharacterFromFile(c);
-        }
-        
-        // Add space character
-        std::vector<std::string> space(artHeight, "     ");
-        charMap[' '] = space;
-    }
-    
-    void loadCharacterFromFile(char c)
-    {
-        std::string filename = "src/utils/data/characters/" + std::string(1, c) + ".txt";
-        std::ifstream file(filename);
-        std::vector<std::string> lines;
-        
-        if (file.is_open())
-        {
-            std::string line;
-            while (std::getline(file, line) && lines.size() < artHeight)
-            {
-                // Ensure consistent width
-                if (line.length() < 10) {
-                    line += std::string(10 - line.length(), ' ');
-                }
-                lines.push_back(line);
-            }
-            file.close();
-            
-            // Fill to required height
-            while (lines.size() < artHeight)
-            {
-                lines.push_back(std::string(10, ' '));
-            }
-        }
-        else
-        {
-            // Create simple fallback
-            std::vector<std::string> fallback(artHeight, std::string(5, ' ') + c + std::string(4, ' '));
-            lines = fallback;
-        }
-        
-        charMap[c] = lines;
-    }
-    
-    std::vector<std::string> textToASCII(const std::string& text, int scrollPos = 0)
-    {
-        std::vector<std::string> result(artHeight);
-        
-        // Calculate visible portion based on scroll
-        std::string displayText = text + "   " + text; // Add padding for smooth scroll
-        int startPos = scrollPos % displayText.length();
-        
-        // Build ASCII art line by line
-        for (int row = 0; row < artHeight; row++)
-        {
-            std::string line = "";
-            for (int i = 0; i < std::min(8, (int)text.length()); i++) // Limit to ~8 chars for width
-            {
-                int charIndex = (startPos + i) % displayText.length();
-                if (charIndex < displayText.length())
-                {
-                    char c = std::toupper(displayText[charIndex]);
-                    if (charMap.find(c) != charMap.end())
-                    {
-                        line += charMap[c][row];
-                    }
-                    else
-                    {
-                        line += std::string(10, ' ');
-                    }
-                }
-            }
-            result[row] = line;
-        }
-        
-        return result;
-    }
-    
-    int getHeight() const { return artHeight; }
-};
+// Rows always left to the text console; marquee lanes that do not fit above them are cut off
+#define MIN_CONSOLE_ROWS 4
 
 class DisplayHandler
 {
 private:
-    HANDLE hConsole;
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    Terminal* terminal;
     
     // Screen dimensions and layout settings
     int consoleWidth;
     int consoleHeight;
+    int marqueeRows;    // Rows of the marquee band, before fitting it on screen
     int marqueeHeight;
     int textConsoleWidth;
     int gifSectionWidth;
     int textConsoleHeight;
     
+    // Back/front cell grids; sections draw into the back buffer and flushFrame() sends the diff
+    FrameBuffer frameBuffer;
+    
+    // Draws the sections of large frames in parallel, nullptr to always draw on this thread
+    ThreadPool* renderPool;
+    
     // Current display state
-    std::vector<std::string> currentGifFrame;
-    std::vector<std::string> textConsoleLines;
-    std::string currentMarqueeText;
-    std::vector<std::string> currentMarqueeDisplay;
-    int marqueePosition;
+    std::vector<char> gifCanvas;  // Current gif frame, kept to redraw the pane after a clear
+    int gifWidth;
+    int gifHeight;
+    bool gifNeedsFullDraw;        // Pane must be redrawn from gifCanvas rather than from runs
+    RingBuffer<std::string> textConsoleLines;  // Scrollback, newest line last
+    int scrollOffset;                          // Lines the console is scrolled back from the newest
+    TripleBuffer<CellGrid>* marqueeFrames;  // Band published by MarqueeLanes, nullptr until connected
     
-    // Marquee ASCII art handler
-    SimpleASCIIArt* asciiArt;
-    bool useASCIIArt;
+    // Font shared with MarqueeLogicHandler; sets the height of the marquee band until the first band arrives
+    std::shared_ptr<const FileReader> font;
     
     // Input area management
     int inputAreaY;
+    int inputCursorX;
     std::string currentInputLine;
     bool isInInputMode;
     
-    // OS emulator state pointers
-    bool *isRunning;
-    bool *isAnimating;
-    int *speed;
-    std::string *marqueeText;
-    
 public:
     /**
      * Constructor for DisplayHandler
-     * @param isRunning Pointer to the running state of the OS emulator
-     * @param isAnimating Pointer to the animation state
-     * @param speed Pointer to the marquee speed
-     * @param marqueeText Pointer to the marquee text
+     * @param terminal Console backend to draw on
+     * @param font Shared font from FontCache used by the marquee
      */
-    DisplayHandler(bool *isRunning, bool *isAnimating, int *speed, std::string *marqueeText)
+    DisplayHandler(Terminal *terminal, std::shared_ptr<const FileReader> font)
+        : textConsoleLines(SCROLLBACK_LINES)
     {
-        this->isRunning = isRunning;
-        this->isAnimating = isAnimating;
-        this->speed = speed;
-        this->marqueeText = marqueeText;
-        
-        hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
+        this->terminal = terminal;
+        this->font = font;
         
         // Initialize layout dimensions
-        consoleWidth = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-        consoleHeight = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
-        
-        marqueeHeight = 8;  // Increased height for ASCII art marquee
-        textConsoleWidth = consoleWidth * 0.6;  // Left 60% for text console
-        gifSectionWidth = consoleWidth * 0.4;   // Right 40% for gif section
-        textConsoleHeight = consoleHeight - marqueeHeight;
-        
-        // Ensure minimum console dimensions to prevent errors
-        if (consoleHeight < 12) {
-            marqueeHeight = std::max(1, consoleHeight / 3);  // Use 1/3 of height for marquee
-            textConsoleHeight = consoleHeight - marqueeHeight;
-        }
-        
-        // Ensure textConsoleHeight is positive and reasonable
-        if (textConsoleHeight < 3) {
-            textConsoleHeight = 3;  // Minimum 3 lines for text console
-        }
-        
-        marqueePosition = 0;
-        currentMarqueeText = *marqueeText;
+        terminal->getSize(consoleWidth, consoleHeight);
+        marqueeRows = font->getLineHeight();  // One line of ASCII art
+        layout();
+        
+        scrollOffset = 0;
+        gifWidth = 0;
+        gifHeight = 0;
+        gifNeedsFullDraw = true;
+        marqueeFrames = nullptr;
+        renderPool = nullptr;
         isInInputMode = false;
         currentInputLine = "";
+        inputCursorX = 0;
         
-        // Calculate input area position (last line of text console)
-        inputAreaY = marqueeHeight + textConsoleHeight - 1;
-        
-        // Initialize ASCII art support
-        try {
-            asciiArt = new SimpleASCIIArt();
-            useASCIIArt = true;
-        } catch (const std::exception& e) {
-            asciiArt = nullptr;
-            useASCIIArt = false;
-        }
-        
-        // Initialize console lines storage with bounds checking
-        int reserveSize = std::max(0, textConsoleHeight - 2);  // Ensure non-negative
-        if (reserveSize > 0 && reserveSize < 10000) {  // Reasonable upper bound
-            textConsoleLines.reserve(reserveSize);
-        }
+        frameBuffer.resize(consoleWidth, consoleHeight);
     }
     
     /**
-     * Destructor - Clean up resources
+     * Destructor - the shared font is released with the last handle
      */
     ~DisplayHandler()
     {
-        if (asciiArt) {
-            delete asciiArt;
-        }
     }
     
     /**
@@ -224,37 +99,80 @@ public:
      */
     void updateDisplay()
     {
-        // Hide cursor during updates to prevent flickering
-        CONSOLE_CURSOR_INFO cursorInfo;
-        GetConsoleCursorInfo(hConsole, &cursorInfo);
-        bool wasVisible = cursorInfo.bVisible;
+        // A new band height moves every section, so it is picked up before any of them is drawn
+        fetchMarqueeBand();
+        
+        // Compose every section into the back buffer, then send only what changed.
+        // Sections cover disjoint cells, so on large screens they are drawn at once, with the
+        // marquee split into tiles of rows; run() returns when all are drawn, before the flush.
+        int rowsPerTile = std::max(1, RENDER_TILE_CELLS / std::max(1, consoleWidth));
+        int marqueeTiles = (marqueeHeight + rowsPerTile - 1) / rowsPerTile;
+        
+        auto drawPart = [this, rowsPerTile, marqueeTiles](int part) {
+            if (part < marqueeTiles) {
+                drawMarqueeRows(part * rowsPerTile, std::min(marqueeHeight, (part + 1) * rowsPerTile));
+            } else if (part == marqueeTiles) {
+                drawTextConsole();
+            } else if (part == marqueeTiles + 1) {
+                drawGifSection();
+            } else {
+                drawInputArea();
+            }
+        };
         
-        if (wasVisible) {
-            cursorInfo.bVisible = false;
-            SetConsoleCursorInfo(hConsole, &cursorInfo);
+        int parts = marqueeTiles + 3;
+        if (renderPool && consoleWidth * consoleHeight >= 2 * RENDER_TILE_CELLS) {
+            renderPool->run(parts, drawPart);
+        } else {
+            for (int part = 0; part < parts; part++) {
+                drawPart(part);
+            }
         }
         
-        // Only update specific sections instead of clearing entire screen
-        drawMarqueeSection();
-        drawTextConsole();
-        drawGifSection();
-        drawInputArea();
-        
-        // Restore cursor visibility only if it was visible before
-        if (wasVisible)
-        {
-            cursorInfo.bVisible = true;
-            SetConsoleCursorInfo(hConsole, &cursorInfo);
-        }
+        flushFrame();
+    }
+    
+    /**
+     * Connects the pool large frames are drawn with
+     * @param pool Shared thread pool, nullptr to draw every section on the calling thread
+     */
+    void connectRenderPool(ThreadPool* pool)
+    {
+        renderPool = pool;
     }
     
     /**
-     * Updates the gif section with new frame data
-     * @param frameData Array of strings representing the current gif frame
+     * Replaces the whole gif frame, e.g. with an animation's keyframe
+     * @param frame View of the new frame
      */
-    void updateGifFrame(const std::vector<std::string>& frameData)
+    void updateGifFrame(const FrameView& frame)
     {
-        currentGifFrame = frameData;
+        gifWidth = frame.width;
+        gifHeight = frame.height;
+        gifCanvas.assign(frame.cells, frame.cells + frame.width * frame.height);
+        gifNeedsFullDraw = true;
+    }
+    
+    /**
+     * Advances the gif to the given frame by applying only the cell runs that changed,
+     * both to the canvas and straight into the frame buffer
+     * @param pack Animation holding the runs, with the same size as the current frame
+     * @param index Frame to advance to
+     */
+    void applyGifDelta(const FramePack& pack, int index)
+    {
+        int startX = textConsoleWidth + 1;
+        int startY = marqueeHeight;
+        int paneWidth = gifSectionWidth - 1;
+        
+        pack.forEachRun(index, [&](int row, int col, const char* cells, int length) {
+            std::copy(cells, cells + length, gifCanvas.begin() + row * gifWidth + col);
+            
+            // A pending full redraw will pick the change up from the canvas
+            if (!gifNeedsFullDraw && row < textConsoleHeight && col < paneWidth) {
+                frameBuffer.write(startX + col, startY + row, cells, std::min(length, paneWidth - col));
+            }
+        });
     }
     
     /**
@@ -263,13 +181,12 @@ public:
      */
     void addConsoleOutput(const std::string& line)
     {
-        textConsoleLines.push_back(line);
+        textConsoleLines.push(line);
         
-        // Keep only the lines that fit in the console height (minus input area)
-        int maxLines = textConsoleHeight - 2; // -2 for input area
-        if (textConsoleLines.size() > maxLines)
+        // While scrolled back, keep showing the same lines instead of following the new one
+        if (scrollOffset > 0)
         {
-            textConsoleLines.erase(textConsoleLines.begin());
+            scrollOffset = std::min(scrollOffset + 1, maxScrollOffset());
         }
     }
     
@@ -286,23 +203,27 @@ public:
     }
     
     /**
-     * Updates the marquee position and text for animation
-     * @param position New marquee position
+     * Scrolls the text console through its scrollback and redraws only the console pane
+     * @param pages Pages to move; positive scrolls back to older lines, negative towards the newest
      */
-    void updateMarqueePosition(int position)
+    void scrollConsole(int pages)
     {
-        marqueePosition = position;
-        // Update current marquee text cache
-        currentMarqueeText = *marqueeText;
+        int pageLines = std::max(1, textConsoleHeight - 2);
+        long long offset = (long long)scrollOffset + (long long)pages * pageLines;
+        scrollOffset = (int)std::max(0LL, std::min(offset, (long long)maxScrollOffset()));
+        
+        drawTextConsole();
+        flushFrame();
     }
     
     /**
-     * Updates the marquee display with data from MarqueeLogicHandler
-     * @param marqueeLines Vector of strings representing the current marquee display
+     * Connects the marquee band; the newest one is drawn on every update, and the
+     * marquee section grows or shrinks with the band's height
+     * @param frames Band exchange from MarqueeLanes::getBand()
      */
-    void updateMarqueeDisplay(const std::vector<std::string>& marqueeLines)
+    void connectMarqueeFrames(TripleBuffer<CellGrid>* frames)
     {
-        currentMarqueeDisplay = marqueeLines;
+        marqueeFrames = frames;
     }
     
     /**
@@ -313,42 +234,50 @@ public:
         isInInputMode = true;
         currentInputLine = "";
         
-        // Position cursor at the input area
-        setCursorPosition(0, inputAreaY);
-        std::cout << "CSOPESY> ";
-        
-        // Show cursor for input
-        CONSOLE_CURSOR_INFO cursorInfo;
-        GetConsoleCursorInfo(hConsole, &cursorInfo);
-        cursorInfo.bVisible = true;
-        SetConsoleCursorInfo(hConsole, &cursorInfo);
+        // Draw the empty prompt at the input area; the cursor is shown from now on
+        drawInputArea();
+        flushFrame();
     }
     
     /**
-     * Updates the current input line for display
+     * Sets the input line without drawing it; the next updateDisplay() shows it
+     * @param input Current input string
+     */
+    void setInputLine(const std::string& input)
+    {
+        currentInputLine = input;
+    }
+    
+    /**
+     * Updates the current input line for display, redrawing only the input row
      * @param input Current input string
      */
     void updateInputLine(const std::string& input)
     {
         currentInputLine = input;
         drawInputArea();
+        flushFrame();
     }
     
     /**
-     * Displays command response in the text console
-     * @param response Vector of response lines from command handler
+     * Adds a batch of command responses to the text console; the caller redraws once with updateDisplay()
+     * @param response Vector of response lines from command handler, starting with CLEAR_CONSOLE if the batch cleared the console
      */
     void displayCommandResponse(const std::vector<std::string>& response)
     {
+        std::size_t first = 0;
+        
         // Check for special commands
         if (!response.empty() && response[0] == "CLEAR_CONSOLE")
         {
-            clearConsole();
-            return;
+            clearScrollback();
+            first = 1;
         }
         
-        addConsoleOutput(response);
-        updateDisplay();
+        for (std::size_t i = first; i < response.size(); i++)
+        {
+            addConsoleOutput(response[i]);
+        }
     }
 
 private:
@@ -357,125 +286,135 @@ private:
      */
     void clearScreen()
     {
-        // Use Windows API for faster clearing
-        COORD coordScreen = {0, 0};
-        DWORD cCharsWritten;
-        DWORD dwConSize;
-        
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        dwConSize = csbi.dwSize.X * csbi.dwSize.Y;
+        terminal->clearScreen();
         
-        FillConsoleOutputCharacter(hConsole, (TCHAR)' ', dwConSize, coordScreen, &cCharsWritten);
-        FillConsoleOutputAttribute(hConsole, csbi.wAttributes, dwConSize, coordScreen, &cCharsWritten);
-        SetConsoleCursorPosition(hConsole, coordScreen);
+        // The screen is blank now, keep both buffers in step with it
+        frameBuffer.clear();
+        frameBuffer.markScreenCleared();
+        gifNeedsFullDraw = true;
     }
     
     /**
-     * Sets cursor position on the console
-     * @param x X coordinate
-     * @param y Y coordinate
+     * Sends the cells that changed since the last flush to the console,
+     * then parks the cursor at the end of the input line
      */
-    void setCursorPosition(int x, int y)
+    void flushFrame()
     {
-        COORD coord;
-        coord.X = x;
-        coord.Y = y;
-        SetConsoleCursorPosition(hConsole, coord);
+        // Hide cursor during updates to prevent flickering
+        terminal->setCursorVisible(false);
+        
+        frameBuffer.flush([this](int x, int y, const char* text, int length) {
+            terminal->moveCursor(x, y);
+            terminal->write(text, length);
+        });
+        
+        // Position cursor at end of input for typing
+        if (isInInputMode) {
+            terminal->moveCursor(inputCursorX, inputAreaY);
+            terminal->setCursorVisible(true);
+        }
+        
+        // The whole frame goes out in one write
+        terminal->flush();
     }
     
     /**
-     * Draws the marquee section at the top of the screen using data from MarqueeLogicHandler
+     * Works out where each section goes from the screen size and the marquee band's height
      */
-    void drawMarqueeSection()
+    void layout()
     {
-        // Draw top border
-        setCursorPosition(0, 0);
-        std::cout << "+" << std::string(consoleWidth - 2, '=') << "+";
-        
-        // Draw marquee content from MarqueeLogicHandler
-        if (!currentMarqueeDisplay.empty()) {
-            for (int i = 0; i < currentMarqueeDisplay.size() && i < marqueeHeight - 2; i++) {
-                setCursorPosition(0, i + 1);
-                std::cout << "|";
-
-                std::string line = currentMarqueeDisplay[i];
-                if (line.length() > consoleWidth - 2) {
-                    line = line.substr(0, consoleWidth - 2);
-                } else if (line.length() < consoleWidth - 2) {
-                    line += std::string(consoleWidth - 2 - line.length(), ' ');
-                }
-                std::cout << line << "|";
-            }
-            
-            // Fill remaining height if marquee display has fewer lines than available space
-            for (int i = currentMarqueeDisplay.size(); i < marqueeHeight - 2; i++) {
-                setCursorPosition(0, i + 1);
-                std::cout << "|" << std::string(consoleWidth - 2, ' ') << "|";
-            }
-        } else {
-            // Show empty marquee if no display data available
-            for (int i = 1; i < marqueeHeight - 1; i++) {
-                setCursorPosition(0, i);
-                std::cout << "|" << std::string(consoleWidth - 2, ' ') << "|";
-            }
+        marqueeHeight = marqueeRows + 2;  // Lane rows plus top and bottom border
+        textConsoleWidth = consoleWidth * 0.6;  // Left 60% for text console
+        gifSectionWidth = consoleWidth * 0.4;   // Right 40% for gif section
+        
+        // Lanes past what leaves the text console its minimum are cut off
+        if (consoleHeight - marqueeHeight < MIN_CONSOLE_ROWS) {
+            marqueeHeight = std::max(3, consoleHeight - MIN_CONSOLE_ROWS);
+        }
+        textConsoleHeight = consoleHeight - marqueeHeight;
+        
+        // Ensure minimum console dimensions to prevent errors
+        if (consoleHeight < 12) {
+            marqueeHeight = std::max(1, consoleHeight / 3);  // Use 1/3 of height for marquee
+            textConsoleHeight = consoleHeight - marqueeHeight;
+        }
+        
+        // Ensure textConsoleHeight is positive and reasonable
+        if (textConsoleHeight < 3) {
+            textConsoleHeight = 3;  // Minimum 3 lines for text console
         }
         
-        // Draw bottom border
-        setCursorPosition(0, marqueeHeight - 1);
-        std::cout << "+" << std::string(consoleWidth - 2, '=') << "+";
+        // Calculate input area position (last line of text console)
+        inputAreaY = marqueeHeight + textConsoleHeight - 1;
     }
     
     /**
-     * Draws the marquee text
+     * Picks up the newest band MarqueeLanes published; if lanes were added or removed, every section moves
      */
-    void drawMarqueeText()
+    void fetchMarqueeBand()
     {
-        std::string displayText = *marqueeText;
-        int textLength = displayText.length();
-        int availableWidth = consoleWidth - 2; // Account for side borders
-        std::string output;
+        if (!marqueeFrames || !marqueeFrames->fetch())
+            return;
         
-        if (*isAnimating && textLength > 0)
-        {
-            // Create scrolling effect
-            std::string scrollText = displayText + "    " + displayText; // Add padding
-            int startPos = marqueePosition % (textLength + 4);
-            
-            std::string visibleText = scrollText.substr(startPos, availableWidth);
-            if (visibleText.length() < availableWidth)
-            {
-                visibleText += scrollText.substr(0, availableWidth - visibleText.length());
-            }
-            
-            output = visibleText;
+        const CellGrid& frame = marqueeFrames->readBuffer();
+        if (frame.height != marqueeRows) {
+            // Start from blank cells: not every cell belongs to a section that redraws it
+            marqueeRows = frame.height;
+            layout();
+            frameBuffer.clear();
+            scrollOffset = std::min(scrollOffset, maxScrollOffset());
+            gifNeedsFullDraw = true;
         }
-        else
-        {
-            // Static display - center the text
-            int padding = (availableWidth - textLength) / 2;
-            if (padding > 0)
-            {
-                output += std::string(padding, ' ');
+    }
+    
+    /**
+     * Draws rows of the marquee section at the top of the screen from the band last fetched:
+     * borders and lanes, blank rows past the end of the band
+     * @param first First row to draw, 0 being the top border
+     * @param last Row after the last one to draw, at most marqueeHeight
+     */
+    void drawMarqueeRows(int first, int last)
+    {
+        const CellGrid* frame = marqueeFrames ? &marqueeFrames->readBuffer() : nullptr;
+        
+        for (int y = first; y < last; y++) {
+            if (y == 0 || y == marqueeHeight - 1) {
+                // Top and bottom border
+                frameBuffer.put(0, y, '+');
+                frameBuffer.fill(1, y, consoleWidth - 2, '=');
+                frameBuffer.put(consoleWidth - 1, y, '+');
+                continue;
             }
-            output += displayText;
-            if (padding > 0)
-            {
-                output += std::string(availableWidth - textLength - padding, ' ');
+            
+            int i = y - 1;  // Band row
+            frameBuffer.put(0, y, '|');
+            
+            if (frame && i < frame->height) {
+                frameBuffer.write(1, y, &frame->cells[i * frame->width], frame->width, consoleWidth - 2);
+            } else {
+                frameBuffer.fill(1, y, consoleWidth - 2, ' ');
             }
+            
+            frameBuffer.put(consoleWidth - 1, y, '|');
         }
-        
-        // Ensure output is exactly the right width
-        if (output.length() > availableWidth)
-        {
-            output = output.substr(0, availableWidth);
-        }
-        else if (output.length() < availableWidth)
-        {
-            output += std::string(availableWidth - output.length(), ' ');
-        }
-        
-        // Output entire line at once to reduce flickering
-        std::cout << output;
+    }
+    
+    /**
+     * Gets how far back the console can scroll: to where the oldest kept line is at the top
+     */
+    int maxScrollOffset()
+    {
+        int maxLines = textConsoleHeight - 2;
+        return std::max(0, (int)textConsoleLines.size() - maxLines);
+    }
+    
+    /**
+     * Empties the scrollback and returns to the newest line
+     */
+    void clearScrollback()
+    {
+        textConsoleLines.clear();
+        scrollOffset = 0;
     }
     
     /**
@@ -486,40 +425,37 @@ private:
         // Draw vertical separator
         for (int i = marqueeHeight; i < consoleHeight; i++)
         {
-            setCursorPosition(textConsoleWidth, i);
-            std::cout << "|";
+            frameBuffer.put(textConsoleWidth, i, '|');
         }
         
         // Draw text console content (excluding the input area)
         int startY = marqueeHeight;
         int maxLines = textConsoleHeight - 2; // Leave space for input area
         
-        for (int i = 0; i < textConsoleLines.size() && i < maxLines; i++)
+        // The page of scrollback ending scrollOffset lines before the newest line
+        int last = (int)textConsoleLines.size() - scrollOffset;
+        int first = std::max(0, last - maxLines);
+        int shown = last - first;
+        
+        // Lines are truncated to the console width and padded with spaces to clear old characters
+        for (int i = 0; i < shown; i++)
         {
-            setCursorPosition(0, startY + i);
-            std::string line = textConsoleLines[i];
-            
-            // Truncate line if it's too long for the text console width
-            if (line.length() > textConsoleWidth - 1)
-            {
-                line = line.substr(0, textConsoleWidth - 1);
-            }
-            
-            std::cout << line;
-            
-            // Pad with spaces to clear any remaining characters
-            if (line.length() < textConsoleWidth - 1)
-            {
-                std::cout << std::string(textConsoleWidth - 1 - line.length(), ' ');
-            }
+            frameBuffer.write(0, startY + i, textConsoleLines[first + i], textConsoleWidth - 1);
         }
         
         // Clear any remaining lines before input area
-        for (int i = textConsoleLines.size(); i < maxLines; i++)
+        for (int i = shown; i < maxLines; i++)
+        {
+            frameBuffer.fill(0, startY + i, textConsoleWidth - 1, ' ');
+        }
+        
+        // The row above the input says when newer lines are hidden
+        std::string status;
+        if (scrollOffset > 0)
         {
-            setCursorPosition(0, startY + i);
-            std::cout << std::string(textConsoleWidth - 1, ' ');
+            status = "-- " + std::to_string(scrollOffset) + " newer lines below, PageDown to scroll --";
         }
+        frameBuffer.write(0, inputAreaY - 1, status, textConsoleWidth - 1);
     }
     
     /**
@@ -527,25 +463,12 @@ private:
      */
     void drawInputArea()
     {
-        setCursorPosition(0, inputAreaY);
-        
-        // Clear the input line
-        std::cout << std::string(textConsoleWidth - 1, ' ');
-        
-        // Draw the prompt and current input
-        setCursorPosition(0, inputAreaY);
+        // Draw the prompt and current input, clearing the rest of the line
         std::string promptLine = "CSOPESY> " + currentInputLine;
-
-        if (promptLine.length() > textConsoleWidth - 1) {
-            promptLine = promptLine.substr(0, textConsoleWidth - 1);
-        }
-        
-        std::cout << promptLine;
+        frameBuffer.write(0, inputAreaY, promptLine, textConsoleWidth - 1);
         
-        // Position cursor at end of input for typing
-        if (isInInputMode) {
-            setCursorPosition(promptLine.length(), inputAreaY);
-        }
+        // Remember where the cursor belongs once the frame is flushed
+        inputCursorX = std::min((int)promptLine.length(), textConsoleWidth - 1);
     }
     
     /**
@@ -553,40 +476,33 @@ private:
      */
     void drawGifSection()
     {
-        if (currentGifFrame.empty())
+        if (gifCanvas.empty())
         {
             // Display placeholder when no gif is loaded
             drawGifPlaceholder();
             return;
         }
         
+        // Between full redraws, applyGifDelta() keeps the pane up to date
+        if (!gifNeedsFullDraw)
+        {
+            return;
+        }
+        gifNeedsFullDraw = false;
+        
         int startX = textConsoleWidth + 1;
         int startY = marqueeHeight;
         
-        // Draw gif frame
-        for (int i = 0; i < currentGifFrame.size() && i < textConsoleHeight; i++)
+        // Draw gif frame, each line fitted to the gif section width
+        for (int i = 0; i < gifHeight && i < textConsoleHeight; i++)
         {
-            setCursorPosition(startX, startY + i);
-            std::string frameLine = currentGifFrame[i];
-            
-            // Adjust frame line to fit in gif section width
-            if (frameLine.length() > gifSectionWidth - 1)
-            {
-                frameLine = frameLine.substr(0, gifSectionWidth - 1);
-            }
-            else if (frameLine.length() < gifSectionWidth - 1)
-            {
-                frameLine += std::string(gifSectionWidth - 1 - frameLine.length(), ' ');
-            }
-            
-            std::cout << frameLine;
+            frameBuffer.write(startX, startY + i, &gifCanvas[i * gifWidth], gifWidth, gifSectionWidth - 1);
         }
         
         // Fill remaining space if gif frame has fewer lines than available space
-        for (int i = currentGifFrame.size(); i < textConsoleHeight; i++)
+        for (int i = gifHeight; i < textConsoleHeight; i++)
         {
-            setCursorPosition(startX, startY + i);
-            std::cout << std::string(gifSectionWidth - 1, ' ');
+            frameBuffer.fill(startX, startY + i, gifSectionWidth - 1, ' ');
         }
     }
     
@@ -602,36 +518,17 @@ private:
         // Clear the gif section
         for (int i = 0; i < textConsoleHeight; i++)
         {
-            setCursorPosition(startX, startY + i);
-            std::cout << std::string(gifSectionWidth - 1, ' ');
+            frameBuffer.fill(startX, startY + i, gifSectionWidth - 1, ' ');
         }
         
         // Display placeholder text
         std::string placeholderText = "GIF SECTION";
         int centerX = startX + (gifSectionWidth - placeholderText.length()) / 2;
-        
-        setCursorPosition(centerX, centerY);
-        std::cout << placeholderText;
+        frameBuffer.write(centerX, centerY, placeholderText);
         
         placeholderText = "No animation loaded";
         centerX = startX + (gifSectionWidth - placeholderText.length()) / 2;
-        setCursorPosition(centerX, centerY + 1);
-        std::cout << placeholderText;
-    }
-    
-    /**
-     * Gets the current console dimensions and updates layout
-     */
-    void updateConsoleInfo()
-    {
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        consoleWidth = csbi.srWindow.Right - csbi.srWindow.Left + 1;
-        consoleHeight = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
-        
-        // Recalculate layout dimensions
-        textConsoleWidth = consoleWidth * 0.6;
-        gifSectionWidth = consoleWidth * 0.4;
-        textConsoleHeight = consoleHeight - marqueeHeight;
+        frameBuffer.write(centerX, centerY + 1, placeholderText);
     }
     
 public:
@@ -652,9 +549,12 @@ public:
             "|                                                                              |",
             "|  Commands:                                                                   |",
             "|  * set_text <text>    - Set marquee text                                    |",
+            "|  * set_text_source <path> - Stream marquee text from a file or pipe         |",
             "|  * start_marquee      - Start marquee animation                             |",
             "|  * stop_marquee       - Stop marquee animation                              |",
             "|  * set_speed <ms>     - Set animation speed                                 |",
+            "|  * set_gif_fps <fps> - Set GIF frame rate (0 for its own timing)            |",
+            "|  * lane add|set|remove|list - Manage extra marquee lanes                    |",
             "|  * clear              - Clear console                                       |",
             "|  * exit               - Exit application                                    |",
             "|                                                                              |",
@@ -666,10 +566,10 @@ public:
         updateDisplay();
         
         // Wait for key press
-        _getch();
+        terminal->waitKey();
         
         // Clear and show initial state
-        textConsoleLines.clear();
+        clearScrollback();
         addConsoleOutput("Welcome to CSOPESY Marquee Console");
         addConsoleOutput("Type 'help' for available commands");
         updateDisplay();
@@ -682,49 +582,18 @@ public:
     void displayExit()
     {
         clearScreen();
-        setCursorPosition(0, consoleHeight / 2);
+        isInInputMode = false;
         
         std::string exitMsg = "Thank you for using CSOPESY Marquee Console!";
         int centerX = (consoleWidth - exitMsg.length()) / 2;
-        setCursorPosition(centerX, consoleHeight / 2);
-        std::cout << exitMsg;
+        frameBuffer.write(centerX, consoleHeight / 2, exitMsg);
         
-        setCursorPosition(0, consoleHeight / 2 + 2);
         exitMsg = "Press any key to exit...";
         centerX = (consoleWidth - exitMsg.length()) / 2;
-        setCursorPosition(centerX, consoleHeight / 2 + 2);
-        std::cout << exitMsg;
+        frameBuffer.write(centerX, consoleHeight / 2 + 2, exitMsg);
         
-        _getch();
-    }
-    
-    /**
-     * Clears the text console section
-     */
-    void clearConsole()
-    {
-        textConsoleLines.clear();
+        flushFrame();
         
-        // Force clear all text console lines on screen
-        int startY = marqueeHeight;
-        int maxLines = textConsoleHeight - 2; // Leave space for input area
-        
-        for (int i = 0; i < maxLines; i++)
-        {
-            setCursorPosition(0, startY + i);
-            std::cout << std::string(textConsoleWidth - 1, ' ');
-        }
-        
-        updateDisplay();
-        displayPrompt(); // Redraw the prompt after clearing
-    }
-    
-    /**
-     * Forces a complete redraw of the display
-     */
-    void forceRedraw()
-    {
-        updateConsoleInfo();
-        updateDisplay();
+        terminal->waitKey();
     }
 };
\ No newline at end of file
@@ -1,42 +1,52 @@
+#pragma once
+
 #include <string>
+#include <string_view>
 #include <vector>
-#include <unordered_map>
 #include <fstream>
 #include <iostream>
 #include <cctype>
+#include <cstdint>
 #include <sstream>
 
 #define MAX_HEIGHT 6
 
+/**
+ * Location of one glyph in the atlas
+ */
+typedef struct GlyphEntryStruct
+{
+    uint32_t offset;  // Index of the glyph's first row in the atlas
+    uint16_t width;   // Length of every row; rows are padded to the widest one
+    uint16_t height;  // Number of rows, 0 if the character has no art
+} GlyphEntry;
+
 /**
  * FileReader class for loading and managing ASCII art characters
- * Converted from C to C++ with STL containers
+ *
+ * All glyphs live in one contiguous atlas: each glyph is height rows of width
+ * characters stored back to back. A 256-entry table indexed by the character
+ * byte gives each glyph's offset and size, with lowercase letters sharing
+ * their uppercase entry, so lookups are a single table read.
  */
 class FileReader
 {
 private:
-    // Hash map to store ASCII art by character key
-    std::unordered_map<char, std::vector<std::string>> artMap;
+    std::string atlas;
+    GlyphEntry glyphTable[256];
 
 public:
     /**
-     * Constructor - initializes the file reader
+     * Constructor - initializes the file reader with an empty atlas
      */
     FileReader()
     {
-        // Constructor - nothing specific needed for STL containers
+        clear();
     }
 
     /**
-     * Destructor - cleanup handled automatically by STL containers
-     */
-    ~FileReader()
-    {
-        // Destructor - STL containers handle cleanup automatically
-    }
-
-    /**
-     * Insert ASCII art for a specific character
+     * Insert ASCII art for a specific character by appending it to the atlas.
+     * Meant for loading time; replacing a glyph leaves its old rows unused in the atlas.
      * @param key Character key (A-Z)
      * @param art Vector of strings representing the ASCII art (6 lines)
      */
@@ -44,55 +54,83 @@ public:
     {
         key = std::toupper(key); // Ensure uppercase
 
-        // Ensure we have exactly MAX_HEIGHT lines
-        std::vector<std::string> normalizedArt;
+        // Rows are padded to the widest one so every glyph is a rectangle
+        int artRows = (int)art.size();
+        std::size_t width = 0;
+        for (int i = 0; i < MAX_HEIGHT && i < artRows; i++)
+        {
+            width = std::max(width, art[i].length());
+        }
+
+        GlyphEntry entry;
+        entry.offset = atlas.length();
+        entry.width = width;
+        entry.height = MAX_HEIGHT;
+
+        // Ensure we have exactly MAX_HEIGHT lines, padding with blank rows if needed
         for (int i = 0; i < MAX_HEIGHT; i++)
         {
-            if (i < art.size())
-            {
-                normalizedArt.push_back(art[i]);
-            }
-            else
+            std::size_t rowStart = atlas.length();
+            if (i < artRows)
             {
-                normalizedArt.push_back(""); // Pad with empty strings if needed
+                atlas += art[i];
             }
+            atlas.append(width - (atlas.length() - rowStart), ' ');
         }
 
-        artMap[key] = normalizedArt;
+        glyphTable[(unsigned char)key] = entry;
+        glyphTable[(unsigned char)std::tolower(key)] = entry;
     }
 
     /**
-     * Lookup ASCII art by character key
+     * Gets one row of a character's ASCII art
      * @param key Character to lookup
-     * @return Vector of strings containing the ASCII art, empty if not found
+     * @param row Row index, must be below getGlyphHeight(key)
+     * @return View into the atlas, valid until the atlas is modified
      */
-    std::vector<std::string> lookupArt(char key)
+    std::string_view glyphRow(char key, int row) const
     {
-        key = std::toupper(key);
+        const GlyphEntry &entry = glyphTable[(unsigned char)key];
+        return std::string_view(atlas.data() + entry.offset + row * entry.width, entry.width);
+    }
 
-        auto it = artMap.find(key);
-        if (it != artMap.end())
-        {
-            return it->second;
-        }
+    /**
+     * Gets the width of a character's ASCII art
+     * @param key Character to lookup
+     * @return Width in columns, 0 if the character has no art
+     */
+    int getGlyphWidth(char key) const
+    {
+        return glyphTable[(unsigned char)key].width;
+    }
 
-        // Return empty vector if not found
-        return std::vector<std::string>();
+    /**
+     * Gets the height of a character's ASCII art
+     * @param key Character to lookup
+     * @return Number of rows, 0 if the character has no art
+     */
+    int getGlyphHeight(char key) const
+    {
+        return glyphTable[(unsigned char)key].height;
     }
 
     /**
      * Read ASCII art from file
      * @param filename Name of file to read
+     * @param verbose False to stay silent when the file cannot be opened
      * @return Vector of strings containing the ASCII art
      */
-    std::vector<std::string> readAsciiArt(const std::string &filename)
+    std::vector<std::string> readAsciiArt(const std::string &filename, bool verbose = true)
     {
         std::vector<std::string> art;
         std::ifstream file(filename);
 
         if (!file.is_open())
         {
-            std::cerr << "Could not open file: " << filename << std::endl;
+            if (verbose)
+            {
+                std::cerr << "Could not open file: " << filename << std::endl;
+            }
             return art;
         }
 
@@ -127,8 +165,9 @@ public:
     /**
      * Load all character files from a specific directory
      * @param directory Path to directory containing character files
+     * @param verbose False to load without printing progress or errors, e.g. while the console is on screen
      */
-    void loadAllFiles(const std::string &directory)
+    void loadAllFiles(const std::string &directory, bool verbose = true)
     {
         std::string basePath = directory;
 
@@ -142,14 +181,17 @@ public:
         for (char c = 'A'; c <= 'Z'; c++)
         {
             std::string filename = basePath + c + ".txt";
-            std::vector<std::string> art = readAsciiArt(filename);
+            std::vector<std::string> art = readAsciiArt(filename, verbose);
 
             if (!art.empty() && !art[0].empty()) // Check if we actually read something
             {
                 insertArt(c, art);
-                std::cout << "Loaded ASCII art for character: " << c << std::endl;
+                if (verbose)
+                {
+                    std::cout << "Loaded ASCII art for character: " << c << std::endl;
+                }
             }
-            else
+            else if (verbose)
             {
                 std::cerr << "Could not load ASCII art for character: " << c
                           << " from file: " << filename << std::endl;
@@ -160,14 +202,17 @@ public:
         for (char c = '0'; c <= '9'; c++)
         {
             std::string filename = basePath + c + ".txt";
-            std::vector<std::string> art = readAsciiArt(filename);
+            std::vector<std::string> art = readAsciiArt(filename, verbose);
 
             if (!art.empty() && !art[0].empty())
             {
                 insertArt(c, art);
-                std::cout << "Loaded ASCII art for digit: " << c << std::endl;
+                if (verbose)
+                {
+                    std::cout << "Loaded ASCII art for digit: " << c << std::endl;
+                }
             }
-            else
+            else if (verbose)
             {
                 std::cerr << "Could not load ASCII art for digit: " << c
                           << " from file: " << filename << std::endl;
@@ -179,14 +224,17 @@ public:
         for (char c : specialChars)
         {
             std::string filename = basePath + c + ".txt";
-            std::vector<std::string> art = readAsciiArt(filename);
+            std::vector<std::string> art = readAsciiArt(filename, verbose);
 
             if (!art.empty() && !art[0].empty())
             {
                 insertArt(c, art);
-                std::cout << "Loaded ASCII art for character: " << c << std::endl;
+                if (verbose)
+                {
+                    std::cout << "Loaded ASCII art for character: " << c << std::endl;
+                }
             }
-            else
+            else if (verbose)
             {
                 std::cerr << "Could not load ASCII art for character: " << c
                           << " from file: " << filename << std::endl;
@@ -201,20 +249,36 @@ public:
      */
     bool hasArt(char key) const
     {
-        key = std::toupper(key);
-        return artMap.find(key) != artMap.end();
+        return glyphTable[(unsigned char)key].height != 0;
+    }
+
+    /**
+     * Gets the height of the tallest loaded glyph
+     * @return Rows needed to draw a line of text, MAX_HEIGHT if nothing is loaded
+     */
+    int getLineHeight() const
+    {
+        int height = 0;
+        for (const GlyphEntry &entry : glyphTable)
+        {
+            height = std::max(height, (int)entry.height);
+        }
+        return height > 0 ? height : MAX_HEIGHT;
     }
 
     /**
      * Get all loaded character keys
-     * @return Vector of characters that have ASCII art loaded
+     * @return Vector of characters that have ASCII art loaded (lowercase aliases excluded)
      */
     std::vector<char> getLoadedKeys() const
     {
         std::vector<char> keys;
-        for (const auto &pair : artMap)
+        for (int c = 0; c < 256; c++)
         {
-            keys.push_back(pair.first);
+            if (glyphTable[c].height != 0 && !std::islower(c))
+            {
+                keys.push_back((char)c);
+            }
         }
         return keys;
     }
@@ -224,6 +288,10 @@ public:
      */
     void clear()
     {
-        artMap.clear();
+        atlas.clear();
+        for (GlyphEntry &entry : glyphTable)
+        {
+            entry = GlyphEntry{0, 0, 0};
+        }
     }
 };
\ No newline at end of file
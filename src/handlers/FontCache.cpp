@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FileReader.cpp"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#define FONT_DIRECTORY "utils/data/characters/"
+
+/**
+ * FontCache - Process-wide store of loaded ASCII art fonts
+ *
+ * Each font directory is parsed once; every caller gets a shared, read-only
+ * handle to the same FileReader, so the display layer and the marquee logic
+ * always render identical glyphs.
+ */
+class FontCache
+{
+public:
+    /**
+     * Gets a font, loading it on first use
+     * @param directory Directory containing the character files
+     * @param verbose False to load without printing, for fonts loaded while the console is on screen
+     * @return Shared handle to the loaded font; it has no glyphs if the directory held none
+     */
+    static std::shared_ptr<const FileReader> get(const std::string &directory = FONT_DIRECTORY, bool verbose = true)
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        std::map<std::string, std::shared_ptr<const FileReader>> &fonts = loadedFonts();
+
+        auto it = fonts.find(directory);
+        if (it != fonts.end())
+        {
+            return it->second;
+        }
+
+        std::shared_ptr<FileReader> font = std::make_shared<FileReader>();
+        font->loadAllFiles(directory, verbose);
+
+        fonts[directory] = font;
+        return font;
+    }
+
+private:
+    static std::map<std::string, std::shared_ptr<const FileReader>> &loadedFonts()
+    {
+        static std::map<std::string, std::shared_ptr<const FileReader>> fonts;
+        return fonts;
+    }
+
+    static std::mutex &cacheMutex()
+    {
+        static std::mutex mutex;
+        return mutex;
+    }
+};
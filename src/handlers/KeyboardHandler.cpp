@@ -2,29 +2,33 @@
 #include <string>
 #include <vector>
 #include <queue>
-#include <conio.h>
-#include <windows.h>
 #include <functional>
+#include "../utils/Terminal.cpp"
+#include "../utils/CommandHistory.cpp"
+#include "CommandHandler.cpp"
 
 class KeyboardHandler
 {
 private:
-    // Keyboard buffer for input management
-    std::queue<char> keyBuffer;
+    // Keys waiting for processBuffer(), regular and special alike, in the order they were read
+    std::queue<KeyEvent> keyBuffer;
     std::string currentInput;
-    std::vector<std::string> commandHistory;
+    CommandHistory commandHistory;
     int historyIndex;
+    
+    // Ctrl+R reverse search state
+    bool isSearching;
+    std::string searchQuery;
+    long long searchMatch;   // History index of the shown match, -1 for none
+    bool searchFailed;       // The last search found nothing older
+    std::string inputBeforeSearch;
     int cursorPos;
     bool capsLock;
-    
-    // Console handle for cursor manipulation
-    HANDLE hConsole;
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
 
     // OS emulator state pointers
     bool *isRunning;
     bool *isAnimating;
-    int *speed;
+    double *speed;
     std::string *marqueeText;
     
     // Producer-Consumer callback function
@@ -32,6 +36,13 @@ private:
     
     // Input display callback function for real-time input display
     std::function<void(const std::string&)> inputDisplayCallback;
+    bool inputChanged;  // The input line needs sending to the display at the end of the batch
+    
+    // Console output callback for messages such as tab completions
+    std::function<void(const std::string&)> consoleOutputCallback;
+    
+    // Scroll callback for PageUp/PageDown, given the number of pages back to move
+    std::function<void(int)> scrollCallback;
     
 public:
     /**
@@ -41,7 +52,7 @@ public:
      * @param speed Pointer to the marquee speed
      * @param marqueeText Pointer to the marquee text
      */
-    KeyboardHandler(bool *isRunning, bool *isAnimating, int *speed, std::string *marqueeText)
+    KeyboardHandler(bool *isRunning, bool *isAnimating, double *speed, std::string *marqueeText)
     {
         this->isRunning = isRunning;
         this->isAnimating = isAnimating;
@@ -49,48 +60,46 @@ public:
         this->marqueeText = marqueeText;
         this->currentInput = "";
         this->historyIndex = -1;
+        this->isSearching = false;
+        this->searchMatch = -1;
+        this->searchFailed = false;
         this->cursorPos = 0;
         this->capsLock = false;
-        this->hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        this->inputChanged = false;
     }
     
     /**
-     * Polls keyboard for input and buffers keystrokes
-     * This is the main polling function called in the OS emulator loop
+     * Buffers a keystroke read by the input stage until processBuffer()
+     * @param key Key read from the terminal
      */
-    void pollKeyboard()
+    void queueKey(const KeyEvent& key)
     {
-        while (_kbhit())
-        {
-            int key = _getch();
-            
-            // Handle special keys that return two values
-            if (key == 0 || key == 224)
-            {
-                int specialKey = _getch();
-                handleSpecialKey(specialKey);
-            }
-            else
-            {
-                // Buffer regular keys
-                keyBuffer.push(static_cast<char>(key));
-            }
-        }
+        keyBuffer.push(key);
     }
     
     /**
-     * Processes buffered keystrokes and sends commands via callback
+     * Processes buffered keystrokes strictly in the order they were read and sends commands via callback
      * Commands are now enqueued in CommandHandler instead of returned
      */
     void processBuffer()
     {
         while (!keyBuffer.empty())
         {
-            char key = keyBuffer.front();
+            KeyEvent key = keyBuffer.front();
             keyBuffer.pop();
             
-            handleKey(key); // No longer returns commands
+            if (key.special)
+            {
+                handleSpecialKey(key.code);
+            }
+            else
+            {
+                handleKey(static_cast<char>(key.code)); // No longer returns commands
+            }
         }
+        
+        // However many keys arrived together, the display gets one update
+        flushInputDisplay();
     }
     
     /**
@@ -128,49 +137,37 @@ public:
      * Gets command history for debugging/display purposes
      * @return Vector of previous commands
      */
-    std::vector<std::string> getCommandHistory() const
+    std::vector<std::string> getCommandHistory()
     {
-        return commandHistory;
+        std::vector<std::string> commands;
+        for (std::size_t i = 0; i < commandHistory.size(); i++)
+        {
+            commands.push_back(commandHistory.get(i));
+        }
+        return commands;
     }
     
     /**
-     * Updates console cursor position for proper display
+     * Marks the input line as changed; it is sent to the display once per batch of keys
      */
-    void updateCursorPosition()
+    void refreshInputDisplay()
     {
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        COORD pos = {static_cast<SHORT>(2 + cursorPos), csbi.dwCursorPosition.Y};
-        SetConsoleCursorPosition(hConsole, pos);
+        inputChanged = true;
     }
     
     /**
-     * Refreshes the input line display
+     * Sends the input line to the display if any key since the last call changed it
      */
-    void refreshInputDisplay()
+    void flushInputDisplay()
     {
-        // Call the input display callback if connected
+        if (!inputChanged)
+            return;
+        inputChanged = false;
+        
+        // The display owns the screen; it redraws the input area from its frame buffer
         if (inputDisplayCallback) {
-            inputDisplayCallback(currentInput);
+            inputDisplayCallback(isSearching ? getSearchLine() : currentInput);
         }
-        
-        // Get current cursor position
-        GetConsoleScreenBufferInfo(hConsole, &csbi);
-        
-        // Move to beginning of line
-        COORD lineStart = {0, csbi.dwCursorPosition.Y};
-        SetConsoleCursorPosition(hConsole, lineStart);
-        
-        // Clear the line
-        std::string clearLine(csbi.dwSize.X, ' ');
-        std::cout << clearLine;
-        
-        // Reset to line start and print current input
-        SetConsoleCursorPosition(hConsole, lineStart);
-        std::cout << "> " << currentInput;
-        
-        // Position cursor correctly
-        COORD cursorPosition = {static_cast<SHORT>(2 + cursorPos), csbi.dwCursorPosition.Y};
-        SetConsoleCursorPosition(hConsole, cursorPosition);
     }
 
     void connectHandler(std::function<void(const std::string&)> callbackFunction)
@@ -183,6 +180,16 @@ public:
         inputDisplayCallback = std::move(callbackFunction);
     }
 
+    void connectConsoleOutput(std::function<void(const std::string&)> callbackFunction)
+    {
+        consoleOutputCallback = std::move(callbackFunction);
+    }
+
+    void connectScroll(std::function<void(int)> callbackFunction)
+    {
+        scrollCallback = std::move(callbackFunction);
+    }
+
 private:
     /**
      * Handles regular key input
@@ -191,6 +198,9 @@ private:
      */
     void handleKey(char key)
     {
+        if (isSearching && handleSearchKey(key))
+            return;
+        
         switch (key)
         {
         case 13: // Enter (Carriage Return)
@@ -217,6 +227,10 @@ private:
             handleCtrlZ();
             break;
             
+        case 18: // Ctrl+R
+            startSearch();
+            break;
+            
         default:
             // Handle printable characters
             if (key >= 32 && key <= 126)
@@ -233,43 +247,53 @@ private:
      */
     void handleSpecialKey(int key)
     {
+        // Navigation keys leave the search with the match ready for editing
+        if (isSearching)
+        {
+            finishSearch(true);
+        }
+        
         switch (key)
         {
-        case 72: // Up arrow - Command history
+        case KEY_UP: // Up arrow - Command history
             navigateHistory(-1);
             break;
             
-        case 80: // Down arrow - Command history
+        case KEY_DOWN: // Down arrow - Command history
             navigateHistory(1);
             break;
             
-        case 75: // Left arrow - Cursor movement
+        case KEY_LEFT: // Left arrow - Cursor movement
             moveCursor(-1);
             break;
             
-        case 77: // Right arrow - Cursor movement
+        case KEY_RIGHT: // Right arrow - Cursor movement
             moveCursor(1);
             break;
             
-        case 83: // Delete key
+        case KEY_DELETE: // Delete key
             handleDelete();
             break;
             
-        case 71: // Home key
+        case KEY_HOME: // Home key
             cursorPos = 0;
             break;
             
-        case 79: // End key
+        case KEY_END: // End key
             cursorPos = currentInput.length();
             break;
             
-        case 73: // Page Up
-            // Could be used for scrolling command history
-            break;
+        case KEY_PAGE_UP: // Page Up - Scroll the text console back
+            if (scrollCallback) {
+                scrollCallback(1);
+            }
+            return;  // The input line did not change
             
-        case 81: // Page Down
-            // Could be used for scrolling command history
-            break;
+        case KEY_PAGE_DOWN: // Page Down - Scroll the text console forward
+            if (scrollCallback) {
+                scrollCallback(-1);
+            }
+            return;
             
         default:
             // Unhandled special key
@@ -287,19 +311,10 @@ private:
     {
         std::string command = currentInput;
         
-        // Add to command history if not empty and different from last command
+        // Add to command history if not empty; CommandHistory skips repeats of the last command
         if (!command.empty())
         {
-            if (commandHistory.empty() || commandHistory.back() != command)
-            {
-                commandHistory.push_back(command);
-                
-                // Limit history size to prevent memory issues
-                if (commandHistory.size() > 100)
-                {
-                    commandHistory.erase(commandHistory.begin());
-                }
-            }
+            commandHistory.add(command);
             
             // Send command to CommandHandler via callback (Producer)
             if (commandCallback)
@@ -310,9 +325,7 @@ private:
         
         // Reset input state
         clearInput();
-        
-        // Move to next line
-        std::cout << std::endl;
+        refreshInputDisplay();
     }
     
     /**
@@ -342,37 +355,25 @@ private:
      */
     void handleTab()
     {
-        std::vector<std::string> commands = {
-            "help", "start_marquee", "stop_marquee", 
-            "set_text", "set_speed", "clear", "cls", "exit"
-        };
-        
-        std::vector<std::string> matches;
-        for (const std::string& cmd : commands)
-        {
-            if (cmd.length() >= currentInput.length() && 
-                cmd.substr(0, currentInput.length()) == currentInput)
-            {
-                matches.push_back(cmd);
-            }
-        }
+        // Completions come from CommandHandler's command table
+        std::vector<std::string_view> matches = CommandHandler::completeCommand(currentInput);
         
         if (matches.size() == 1)
         {
-            currentInput = matches[0];
+            currentInput = std::string(matches[0]);
             cursorPos = currentInput.length();
             refreshInputDisplay();
         }
         else if (matches.size() > 1)
         {
             // Show available matches
-            std::cout << std::endl << "Available completions: ";
+            std::string completions = "Available completions: ";
             for (size_t i = 0; i < matches.size(); i++)
             {
-                std::cout << matches[i];
-                if (i < matches.size() - 1) std::cout << ", ";
+                completions += matches[i];
+                if (i < matches.size() - 1) completions += ", ";
             }
-            std::cout << std::endl;
+            printToConsole(completions);
             refreshInputDisplay();
         }
     }
@@ -382,9 +383,9 @@ private:
      */
     void handleCtrlC()
     {
-        std::cout << "^C" << std::endl;
+        printToConsole("^C");
         clearInput();
-        std::cout << "> ";
+        refreshInputDisplay();
     }
     
     /**
@@ -392,9 +393,20 @@ private:
      */
     void handleCtrlZ()
     {
-        std::cout << "^Z" << std::endl;
+        printToConsole("^Z");
         clearInput();
-        std::cout << "> ";
+        refreshInputDisplay();
+    }
+    
+    /**
+     * Sends a message to the text console through the connected display
+     * @param message Line to print
+     */
+    void printToConsole(const std::string& message)
+    {
+        if (consoleOutputCallback) {
+            consoleOutputCallback(message);
+        }
     }
     
     /**
@@ -426,7 +438,7 @@ private:
      */
     void navigateHistory(int direction)
     {
-        if (commandHistory.empty()) return;
+        if (commandHistory.size() == 0) return;
         
         if (direction == -1) // Previous command
         {
@@ -456,13 +468,114 @@ private:
         
         if (historyIndex != -1)
         {
-            currentInput = commandHistory[historyIndex];
+            currentInput = commandHistory.get(historyIndex);
             cursorPos = currentInput.length();
         }
         
         refreshInputDisplay();
     }
     
+    /**
+     * Handles Ctrl+R - starts a reverse search through the command history
+     */
+    void startSearch()
+    {
+        isSearching = true;
+        searchQuery = "";
+        searchMatch = -1;
+        searchFailed = false;
+        inputBeforeSearch = currentInput;
+        refreshInputDisplay();
+    }
+    
+    /**
+     * Handles a key typed during a reverse search
+     * @param key The character key pressed
+     * @return False if the key ended the search and should be handled as usual
+     */
+    bool handleSearchKey(char key)
+    {
+        switch (key)
+        {
+        case 18: // Ctrl+R - next older match
+            searchHistory(searchMatch >= 0 ? searchMatch : commandHistory.size());
+            break;
+            
+        case 8: // Backspace - shorter query, searched again from the newest command
+            if (!searchQuery.empty())
+            {
+                searchQuery.pop_back();
+            }
+            searchHistory(commandHistory.size());
+            break;
+            
+        case 27: // Escape, Ctrl+C and Ctrl+G give up and bring back the typed input
+        case 3:
+        case 7:
+            finishSearch(false);
+            break;
+            
+        case 13: // Enter runs the match
+            finishSearch(true);
+            return false;
+            
+        default:
+            if (key < 32 || key > 126)
+            {
+                finishSearch(true);
+                return false;
+            }
+            
+            // The current match stays if it still contains the longer query
+            searchQuery += key;
+            searchHistory(searchMatch >= 0 ? searchMatch + 1 : commandHistory.size());
+            break;
+        }
+        
+        refreshInputDisplay();
+        return true;
+    }
+    
+    /**
+     * Looks for the query in commands older than a history index; a miss keeps the previous match
+     * @param before History index to search back from
+     */
+    void searchHistory(std::size_t before)
+    {
+        long long found = commandHistory.search(searchQuery, before);
+        searchFailed = found < 0;
+        if (found >= 0)
+        {
+            searchMatch = found;
+        }
+    }
+    
+    /**
+     * Ends the reverse search
+     * @param useMatch True to put the match in the input line, false to restore what was typed before
+     */
+    void finishSearch(bool useMatch)
+    {
+        isSearching = false;
+        currentInput = useMatch && searchMatch >= 0 ? commandHistory.get(searchMatch) : inputBeforeSearch;
+        cursorPos = currentInput.length();
+        historyIndex = -1;
+    }
+    
+    /**
+     * Gets the input line shown during a reverse search, in the style of bash
+     */
+    std::string getSearchLine()
+    {
+        std::string line = searchFailed ? "(failed reverse-i-search)`" : "(reverse-i-search)`";
+        line += searchQuery + "': ";
+        if (searchMatch >= 0)
+        {
+            line += commandHistory.get(searchMatch);
+        }
+        return line;
+    }
+    
     /**
      * Moves cursor left or right
      * @param direction -1 for left, 1 for right
@@ -0,0 +1,499 @@
+#pragma once
+
+#include "MarqueeLogicHandler.cpp"
+#include "FontCache.cpp"
+#include "../utils/FrameBuffer.cpp"
+#include "../utils/TripleBuffer.cpp"
+#include "../utils/ThreadPool.cpp"
+#include <chrono>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Most lanes the band holds, the main lane included
+#define MAX_LANES 1024
+
+// Lane driven by set_text and set_speed; it is always the top lane and cannot be removed
+#define MAIN_LANE "main"
+
+// Usage of the lane command, shown when it is given the wrong arguments
+#define LANE_USAGE "lane add <name> | lane set <name> text|source|speed|direction|font <value> | lane remove <name> | lane list"
+
+/**
+ * One marquee lane: a named MarqueeLogicHandler and how its font was chosen
+ */
+typedef struct MarqueeLaneStruct
+{
+    std::string name;
+    std::string fontName;  // "default", "plain" or the font directory
+    MarqueeLogicHandler* marquee;
+} MarqueeLane;
+
+/**
+ * MarqueeLanes - Independent marquee lanes stacked into one band
+ *
+ * Each lane is its own MarqueeLogicHandler with its own text, speed,
+ * direction and font. Every pass moves all lanes to where they belong at
+ * that time and draws them, top to bottom, into a single band that is
+ * published to DisplayHandler at once, so however many lanes there are the
+ * display picks up one frame. A lane is as tall as its font, one row for
+ * plain text. The main lane is the original marquee: set_text and set_speed
+ * still control it.
+ *
+ * Used by the logic stage only; DisplayHandler reads the published band.
+ */
+class MarqueeLanes
+{
+private:
+    std::vector<MarqueeLane> lanes;  // Top to bottom; lanes[0] is the main lane
+    int bandWidth;
+
+    // Font new lanes start with, and "font default" returns to
+    std::shared_ptr<const FileReader> defaultFont;
+
+    // Composited lanes for DisplayHandler; each pass fills the write buffer and publishes it
+    TripleBuffer<CellGrid> band;
+    bool needsRedraw;  // A lane changed since the band was last drawn
+    std::vector<int> laneTops;  // Band row each lane starts on, worked out per redraw
+    
+    // Draws groups of lanes in parallel when the band is large, nullptr to draw them all on this thread
+    ThreadPool* renderPool;
+
+    // Shared state of the main lane
+    double *speed;
+    std::string *marqueeText;
+
+    // Called when a lane command sets the main lane's text or text source
+    std::function<void()> mainTextChangeCallback;
+
+public:
+    /**
+     * Constructor for MarqueeLanes; starts with the main lane only
+     * @param width Columns of every lane
+     * @param font Shared font from FontCache for the main lane and new lanes
+     * @param speed Pointer to the main lane's speed
+     * @param marqueeText Pointer to the main lane's text
+     */
+    MarqueeLanes(int width, std::shared_ptr<const FileReader> font, double *speed, std::string *marqueeText)
+    {
+        this->bandWidth = std::max(1, width);
+        this->defaultFont = font;
+        this->speed = speed;
+        this->marqueeText = marqueeText;
+
+        MarqueeLane main;
+        main.name = MAIN_LANE;
+        main.fontName = "default";
+        main.marquee = new MarqueeLogicHandler(bandWidth, font->getLineHeight(), font);
+        main.marquee->setText(*marqueeText);
+        main.marquee->setAnimationSpeed(*speed, std::chrono::steady_clock::now());
+        main.marquee->initialize();
+        main.marquee->startScrolling();
+        lanes.push_back(main);
+
+        CellGrid blank;
+        blank.width = bandWidth;
+        blank.height = main.marquee->getHeight();
+        blank.cells.assign(blank.width * blank.height, ' ');
+        band.reset(blank);
+        needsRedraw = true;
+        renderPool = nullptr;
+    }
+
+    ~MarqueeLanes()
+    {
+        for (MarqueeLane& lane : lanes)
+        {
+            delete lane.marquee;
+        }
+    }
+
+    /**
+     * Sets the main lane's text, as set_text does
+     * @param text New text
+     */
+    void setMainText(const std::string& text)
+    {
+        lanes[0].marquee->setText(text);
+        needsRedraw = true;
+    }
+
+    /**
+     * Streams the main lane's text from a file or named pipe, as set_text_source does
+     * @param path File or named pipe to read
+     * @return Response line
+     */
+    std::string setMainTextSource(const std::string& path)
+    {
+        return setSource(0, path);
+    }
+
+    /**
+     * Sets the main lane's speed; it carries on from where it is at that moment
+     * @param speed Milliseconds per column
+     * @param now Current time
+     */
+    void setMainSpeed(double speed, std::chrono::steady_clock::time_point now)
+    {
+        lanes[0].marquee->setAnimationSpeed(speed, now);
+    }
+
+    /**
+     * Continues every lane from where it stopped, as of a given time
+     * @param now Current time
+     */
+    void resume(std::chrono::steady_clock::time_point now)
+    {
+        for (MarqueeLane& lane : lanes)
+        {
+            lane.marquee->resume(now);
+        }
+    }
+
+    /**
+     * Moves every lane to where it should be at a given time, then draws and publishes the band
+     * @param now Current time
+     */
+    void process(std::chrono::steady_clock::time_point now)
+    {
+        for (MarqueeLane& lane : lanes)
+        {
+            lane.marquee->process(now);
+        }
+        redraw();
+    }
+
+    /**
+     * Draws every lane where it is into the band and publishes it
+     */
+    void redraw()
+    {
+        int laneCount = (int)lanes.size();
+        int rows = 0;
+        laneTops.resize(laneCount);
+        for (int i = 0; i < laneCount; i++)
+        {
+            laneTops[i] = rows;
+            rows += lanes[i].marquee->getHeight();
+        }
+
+        // The write buffer is the producer's alone, so it can change size while the display reads another
+        CellGrid& grid = band.writeBuffer();
+        grid.width = bandWidth;
+        grid.height = rows;
+        grid.cells.resize(bandWidth * rows);
+
+        // Lanes cover disjoint rows; a large band is drawn in groups of lanes at once
+        int lanesPerPart = std::max(1, (int)((long long)RENDER_TILE_CELLS * laneCount / std::max(1, bandWidth * rows)));
+        int parts = (laneCount + lanesPerPart - 1) / lanesPerPart;
+
+        auto drawPart = [this, &grid, lanesPerPart, laneCount](int part) {
+            int last = std::min(laneCount, (part + 1) * lanesPerPart);
+            for (int i = part * lanesPerPart; i < last; i++)
+            {
+                lanes[i].marquee->drawInto(grid, laneTops[i]);
+            }
+        };
+
+        if (renderPool)
+        {
+            renderPool->run(parts, drawPart);
+        }
+        else
+        {
+            for (int part = 0; part < parts; part++)
+            {
+                drawPart(part);
+            }
+        }
+
+        band.publish();
+        needsRedraw = false;
+    }
+
+    /**
+     * Connects the callback told when a lane command sets the main lane's text or text source,
+     * e.g. to drop a set_text from earlier in the same batch that has not been applied yet
+     */
+    void connectMainTextChange(std::function<void()> callback)
+    {
+        mainTextChangeCallback = callback;
+    }
+
+    /**
+     * Connects the pool large bands are drawn with
+     * @param pool Shared thread pool, nullptr to draw every lane on the calling thread
+     */
+    void connectRenderPool(ThreadPool* pool)
+    {
+        renderPool = pool;
+    }
+
+    /**
+     * Checks whether a lane changed since the band was last drawn
+     */
+    bool hasChanges() const
+    {
+        return needsRedraw;
+    }
+
+    /**
+     * Gets the speed of the fastest lane, which sets how often the band needs drawing
+     * @return Milliseconds per column
+     */
+    double getFastestSpeed() const
+    {
+        double fastest = *speed;
+        for (std::size_t i = 1; i < lanes.size(); i++)
+        {
+            fastest = std::min(fastest, lanes[i].marquee->getAnimationSpeed());
+        }
+        return fastest;
+    }
+
+    /**
+     * Gets the number of lanes, the main lane included
+     */
+    int getLaneCount() const
+    {
+        return (int)lanes.size();
+    }
+
+    /**
+     * Gets the exchange the band is published to.
+     * DisplayHandler is its only reader; fetch() and readBuffer() take no lock.
+     * @return Triple buffer of frames as wide as a lane and as tall as all lanes together
+     */
+    TripleBuffer<CellGrid>& getBand()
+    {
+        return band;
+    }
+
+    /**
+     * Runs the lane command
+     * @param arguments Arguments after "lane", e.g. {"set", "news", "speed", "50"}
+     * @param now Current time, from which speed and direction changes take effect
+     * @return Response lines
+     */
+    std::vector<std::string> handleCommand(const std::vector<std::string_view>& arguments, std::chrono::steady_clock::time_point now)
+    {
+        std::string_view action = arguments.empty() ? std::string_view() : arguments[0];
+
+        if (action == "add" && arguments.size() == 2)
+            return {addLane(std::string(arguments[1]), now)};
+        if (action == "remove" && arguments.size() == 2)
+            return {removeLane(std::string(arguments[1]))};
+        if (action == "set" && arguments.size() >= 4)
+            return {setLane(arguments, now)};
+        if (action == "list" && arguments.size() == 1)
+            return listLanes();
+
+        return {"Error: Usage: " LANE_USAGE};
+    }
+
+private:
+    /**
+     * Finds a lane by name
+     * @return Index into lanes, or -1 if there is no such lane
+     */
+    int findLane(const std::string& name) const
+    {
+        for (std::size_t i = 0; i < lanes.size(); i++)
+        {
+            if (lanes[i].name == name)
+                return (int)i;
+        }
+        return -1;
+    }
+
+    /**
+     * Adds an empty lane below the others, with the default font and the main lane's speed
+     * @param name Name for the new lane
+     * @param now Current time; the lane starts scrolling from here
+     */
+    std::string addLane(const std::string& name, std::chrono::steady_clock::time_point now)
+    {
+        if (findLane(name) >= 0)
+            return "Error: Lane \"" + name + "\" already exists.";
+        if (lanes.size() >= MAX_LANES)
+            return "Error: At most " + std::to_string(MAX_LANES) + " lanes are allowed.";
+
+        MarqueeLane lane;
+        lane.name = name;
+        lane.fontName = "default";
+        lane.marquee = new MarqueeLogicHandler(bandWidth, defaultFont->getLineHeight(), defaultFont);
+        lane.marquee->setFont(defaultFont);
+        lane.marquee->setAnimationSpeed(*speed, now);
+        lane.marquee->resume(now);
+        lane.marquee->startScrolling();
+        lanes.push_back(lane);
+
+        needsRedraw = true;
+        return "Lane \"" + name + "\" added.";
+    }
+
+    std::string removeLane(const std::string& name)
+    {
+        int index = findLane(name);
+        if (index < 0)
+            return "Error: No lane named \"" + name + "\".";
+        if (index == 0)
+            return "Error: The main lane cannot be removed.";
+
+        delete lanes[index].marquee;
+        lanes.erase(lanes.begin() + index);
+
+        needsRedraw = true;
+        return "Lane \"" + name + "\" removed.";
+    }
+
+    /**
+     * Changes one property of a lane
+     * @param arguments {"set", name, property, value...}; text values are rejoined with single spaces
+     * @param now Current time
+     */
+    std::string setLane(const std::vector<std::string_view>& arguments, std::chrono::steady_clock::time_point now)
+    {
+        std::string name(arguments[1]);
+        std::string_view property = arguments[2];
+        std::string value(arguments[3]);
+        for (std::size_t i = 4; i < arguments.size(); i++)
+        {
+            value += ' ';
+            value += arguments[i];
+        }
+
+        int index = findLane(name);
+        if (index < 0)
+            return "Error: No lane named \"" + name + "\".";
+        MarqueeLane& lane = lanes[index];
+
+        if (property == "text")
+        {
+            if (index == 0)
+            {
+                *marqueeText = value;
+                if (mainTextChangeCallback)
+                {
+                    mainTextChangeCallback();
+                }
+            }
+            lane.marquee->setText(value);
+            needsRedraw = true;
+            return "Lane \"" + name + "\" text set to: \"" + value + "\"";
+        }
+
+        if (property == "source")
+            return setSource(index, value);
+
+        if (property == "speed")
+        {
+            char* end = nullptr;
+            double laneSpeed = std::strtod(value.c_str(), &end);
+            if (*end != '\0' || !std::isfinite(laneSpeed) || laneSpeed <= 0)
+                return "Error: Speed must be a positive number of milliseconds.";
+
+            // The main lane follows the shared speed, which the logic stage applies
+            if (index == 0)
+            {
+                *speed = laneSpeed;
+            }
+            else
+            {
+                lane.marquee->setAnimationSpeed(laneSpeed, now);
+            }
+            return "Lane \"" + name + "\" speed set to " + formatSpeed(laneSpeed) + ".";
+        }
+
+        if (property == "direction")
+        {
+            if (value != "left" && value != "right")
+                return "Error: Direction must be left or right.";
+            if (!lane.marquee->getTextSource().empty())
+                return "Error: Streamed text always scrolls left.";
+
+            lane.marquee->setDirection(value == "left" ? MARQUEE_LEFT : MARQUEE_RIGHT, now);
+            return "Lane \"" + name + "\" now scrolls " + value + ".";
+        }
+
+        if (property == "font")
+        {
+            std::shared_ptr<const FileReader> font;
+            if (value == "default")
+            {
+                font = defaultFont;
+            }
+            else if (value != "plain")
+            {
+                // Loaded quietly: the console is on screen
+                font = FontCache::get(value, false);
+                if (font->getLoadedKeys().empty())
+                    return "Error: No font found in \"" + value + "\".";
+            }
+
+            lane.marquee->setFont(font);
+            lane.fontName = value;
+            needsRedraw = true;
+            return "Lane \"" + name + "\" font set to " + value + ".";
+        }
+
+        return "Error: Usage: " LANE_USAGE;
+    }
+
+    /**
+     * Streams a lane's text from a file or named pipe
+     * @param index Lane to change
+     * @param path File or named pipe to read
+     * @return Response line
+     */
+    std::string setSource(int index, const std::string& path)
+    {
+        MarqueeLane& lane = lanes[index];
+        if (!lane.marquee->setTextSource(path))
+            return "Error: Could not open \"" + path + "\": " + std::strerror(errno) + ".";
+
+        if (index == 0 && mainTextChangeCallback)
+        {
+            mainTextChangeCallback();
+        }
+
+        needsRedraw = true;
+        return "Lane \"" + lane.name + "\" text streamed from: \"" + path + "\"";
+    }
+
+    /**
+     * Describes every lane, top to bottom
+     */
+    std::vector<std::string> listLanes() const
+    {
+        std::vector<std::string> lines;
+        for (std::size_t i = 0; i < lanes.size(); i++)
+        {
+            const MarqueeLane& lane = lanes[i];
+            double laneSpeed = i == 0 ? *speed : lane.marquee->getAnimationSpeed();
+            std::string source = lane.marquee->getTextSource();
+
+            lines.push_back(" - " + lane.name + ": " + formatSpeed(laneSpeed) + "ms, " +
+                            (lane.marquee->getDirection() == MARQUEE_LEFT ? "left" : "right") + ", font " +
+                            lane.fontName + ", " +
+                            (source.empty() ? "\"" + lane.marquee->getText() + "\"" : "source " + source));
+        }
+        return lines;
+    }
+
+    /**
+     * Formats a speed without trailing zeros, e.g. 100 or 2.5
+     */
+    static std::string formatSpeed(double speed)
+    {
+        std::ostringstream text;
+        text << speed;
+        return text.str();
+    }
+};
@@ -1,9 +1,32 @@
-#include "FileReader.cpp"
-#include <iostream>
+#pragma once
+
+#include "FontCache.cpp"
+#include "../utils/FrameBuffer.cpp"
+#include "../utils/TextSource.cpp"
 #include <string>
 #include <vector>
 #include <mutex>
 #include <chrono>
+#include <cmath>
+
+// Blank characters appended to the text before it wraps around
+#define WRAP_PADDING "   "
+
+// Columns taken by a space (or a character without art) in ASCII art mode
+#define ASCII_SPACE_WIDTH 4
+
+// Blank columns between neighbouring glyphs in ASCII art mode
+#define GLYPH_SPACING 1
+
+// Scroll directions: the text travels towards the left or the right edge
+#define MARQUEE_LEFT 1
+#define MARQUEE_RIGHT -1
+
+// Columns of streamed text rasterized ahead of the right edge of the display
+#define STREAM_LOOKAHEAD 256
+
+// Bytes read from a text source at a time
+#define STREAM_READ_SIZE 4096
 
 /**
  * MarqueeLogicHandler - Handles marquee text animation and ASCII art rendering
@@ -14,26 +37,46 @@ class MarqueeLogicHandler
 private:
     // Text and animation state
     std::string currentText;
-    int scrollPosition;
-    int animationSpeed;  // milliseconds between updates
+    long long scrollPosition;
+    double animationSpeed;  // Milliseconds per column, may be fractional
+    int direction;          // MARQUEE_LEFT or MARQUEE_RIGHT
     
     // ASCII art management
-    FileReader* fileReader;
+    std::shared_ptr<const FileReader> font;
     bool useAsciiArt;
     
     // Display properties
     int displayWidth;
     int displayHeight;
-    std::vector<std::vector<char>> displayBuffer;  // 2D character buffer
     
-    // Animation timing
+    // Whole text (plus wrap padding) rendered once per setText, displayHeight rows of stripWidth columns.
+    // Each frame copies a window as wide as the band it is drawn into; scrollPosition is a strip column.
+    std::vector<char> glyphStrip;
+    int stripWidth;
+    
+    // Streamed text (setTextSource): only a window of columns around the display is ever rasterized.
+    // Columns count from the start of the stream and scrollPosition is one of them, never wrapped;
+    // row r of column c lives at streamColumns[r * streamCapacity + c % streamCapacity].
+    TextSource source;
+    std::vector<char> streamColumns;
+    int streamCapacity;
+    long long windowStart;      // Oldest column still held
+    long long windowEnd;        // Column after the newest one rasterized
+    std::string readBuffer;     // Bytes read but not rasterized yet, from readOffset on
+    std::size_t readOffset;
+    long long bytesSinceRewind; // Tells an empty file from the end of a full one
+    bool endedWithBreak;        // Last byte read was a line break, which already pads the wrap
+    
+    // Animation timing: the scroll position is anchorColumn plus the columns travelled since anchorTime,
+    // so it follows elapsed time however many ticks actually ran
+    std::chrono::steady_clock::time_point anchorTime;
+    double anchorColumn;
     std::chrono::steady_clock::time_point lastUpdate;
     
     // Thread safety
     mutable std::mutex textMutex;
     
     // State flags
-    bool needsUpdate;
     bool isScrolling;
     
 public:
@@ -41,92 +84,120 @@ public:
      * Constructor for MarqueeLogicHandler
      * @param width Display width for the marquee
      * @param height Display height for the marquee
+     * @param font Shared font from FontCache, nullptr to fetch the default font in initialize()
      */
-    MarqueeLogicHandler(int width = 80, int height = 6)
+    MarqueeLogicHandler(int width = 80, int height = 6, std::shared_ptr<const FileReader> font = nullptr)
     {
         currentText = "";
         scrollPosition = 0;
         animationSpeed = 100;  // 100ms default
+        direction = MARQUEE_LEFT;
+        anchorColumn = 0;
         
         // Validate and set dimensions with bounds checking
         displayWidth = std::max(1, std::min(width, 1000));   // Between 1 and 1000
         displayHeight = std::max(1, std::min(height, 100));  // Between 1 and 100
         
         useAsciiArt = false;
-        needsUpdate = false;
         isScrolling = false;
+        stripWidth = 0;
+        streamCapacity = 0;
+        windowStart = 0;
+        windowEnd = 0;
+        readOffset = 0;
+        bytesSinceRewind = 0;
+        endedWithBreak = false;
         
-        // Initialize file reader for ASCII art
-        fileReader = new FileReader();
-        
-        // Initialize display buffer
-        initializeDisplayBuffer();
+        // Font for ASCII art, shared with the rest of the process
+        this->font = font;
         
         lastUpdate = std::chrono::steady_clock::now();
+        anchorTime = lastUpdate;
     }
     
     /**
-     * Destructor
+     * Destructor - the shared font is released with the last handle
      */
     ~MarqueeLogicHandler()
     {
-        if (fileReader)
-        {
-            delete fileReader;
-        }
     }
 
     /**
-     * Initialize the marquee handler
+     * Initialize the marquee handler. Prints nothing: it may run once the console owns the screen.
+     * @return True if the font has ASCII art, false if the marquee falls back to plain text
      */
-    void initialize()
+    bool initialize()
     {
         // Load ASCII art characters
         try
         {
-            fileReader->loadAllFiles();
-            useAsciiArt = true;
-            std::cout << "MarqueeLogicHandler: ASCII art loaded successfully" << std::endl;
+            if (!font)
+            {
+                font = FontCache::get();
+            }
+            useAsciiArt = !font->getLoadedKeys().empty();
         }
-        catch (const std::exception& e)
+        catch (const std::exception&)
         {
-            std::cerr << "MarqueeLogicHandler: Could not load ASCII art: " << e.what() << std::endl;
             useAsciiArt = false;
         }
-        
-        needsUpdate = true;
+        rasterizeStrip();
+        return useAsciiArt;
     }
     
     /**
-     * Main processing loop - handles marquee animation
+     * Moves the marquee to where it should be at a given time; drawInto() shows it there.
+     * The position comes from the time elapsed, not from the number of calls, so the caller
+     * may tick at any rate (or miss ticks) without changing how fast the text travels.
+     * @param now Current time
      */
-    void process()
+    void process(std::chrono::steady_clock::time_point now)
     {
-        auto now = std::chrono::steady_clock::now();
-        
-        // Check if it's time to update animation
-        if (isScrolling && 
-            std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate).count() >= animationSpeed)
+        if (isScrolling)
         {
+            std::lock_guard<std::mutex> lock(textMutex);
+            
+            if (source.isOpen())
             {
-                std::lock_guard<std::mutex> lock(textMutex);
-                
-                if (!currentText.empty())
-                {
-                    // Update scroll position
-                    scrollPosition = (scrollPosition + 1) % (currentText.length() + displayWidth);
-                    needsUpdate = true;
-                }
+                scrollPosition = (long long)std::floor(columnAt(now));
+                fillStream();
+            }
+            else if (stripWidth > 0)
+            {
+                scrollPosition = (long long)wrapColumn(std::floor(columnAt(now)));
             }
             
             lastUpdate = now;
         }
+    }
+    
+    /**
+     * Draws the marquee at its current position into rows of a larger grid, e.g. one lane of a band.
+     * Rows past the bottom of the grid are left out; columns past its width are never drawn.
+     * @param grid Grid to draw into; the marquee fills grid.width columns
+     * @param top First row of the grid to draw on; getHeight() rows are drawn from there
+     */
+    void drawInto(CellGrid& grid, int top) const
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
         
-        // Update display buffer if needed
-        if (needsUpdate)
+        int rows = std::min(displayHeight, grid.height - top);
+        for (int row = 0; row < rows; row++)
         {
-            updateDisplayBuffer();
-            needsUpdate = false;
+            char* out = &grid.cells[(top + row) * grid.width];
+            
+            if (source.isOpen())
+            {
+                copyStreamRow(row, out, grid.width);
+            }
+            else if (stripWidth == 0)
+            {
+                std::fill(out, out + grid.width, ' ');
+            }
+            else
+            {
+                copyStripRow(row, scrollPosition, out, grid.width);
+            }
         }
     }
     
@@ -137,7 +208,8 @@ public:
     {
         std::lock_guard<std::mutex> lock(textMutex);
         currentText = "";
-        clearDisplayBuffer();
+        closeSource();
+        rasterizeStrip();
     }
 
     /**
@@ -159,15 +231,18 @@ public:
     }
     
     /**
-     * Set the marquee text
+     * Set the marquee text, ending any text source
      * @param text New text to display
      */
     void setText(const std::string& text)
     {
         std::lock_guard<std::mutex> lock(textMutex);
+        closeSource();
         currentText = text;
-        scrollPosition = 0;  // Reset scroll position
-        needsUpdate = true;
+        scrollPosition = 0;  // Reset scroll position, counting from the last update
+        anchorColumn = 0;
+        anchorTime = lastUpdate;
+        rasterizeStrip();
     }
     
     /**
@@ -181,13 +256,109 @@ public:
     }
     
     /**
-     * Set animation speed
-     * @param speed Milliseconds between animation updates
+     * Streams the text from a file or named pipe instead, reading only as far ahead as the
+     * marquee has to show. A file starts over after its end; a pipe shows blank until more
+     * is written, and new text enters from the right edge. Streamed text always scrolls left.
+     * @param path File or named pipe to read
+     * @return False if it could not be opened, keeping the current text; errno tells why
      */
-    void setAnimationSpeed(int speed)
+    bool setTextSource(const std::string& path)
     {
         std::lock_guard<std::mutex> lock(textMutex);
-        animationSpeed = std::max(10, speed);  // Minimum 10ms
+        if (!source.open(path))
+            return false;
+        
+        currentText = "";
+        glyphStrip = std::vector<char>();
+        stripWidth = 0;
+        
+        readBuffer.clear();
+        readOffset = 0;
+        bytesSinceRewind = 0;
+        endedWithBreak = false;
+        
+        direction = MARQUEE_LEFT;
+        scrollPosition = 0;  // Start from the first column, counting from the last update
+        anchorColumn = 0;
+        anchorTime = lastUpdate;
+        resetStream();
+        return true;
+    }
+    
+    /**
+     * Gets the file or pipe the text is streamed from
+     * @return Its path, empty for text set with setText()
+     */
+    std::string getTextSource() const
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        return source.getPath();
+    }
+    
+    /**
+     * Set animation speed; the text carries on from where it is at that moment
+     * @param speed Milliseconds per column (1000 / speed columns per second), greater than 0
+     * @param now Current time
+     */
+    void setAnimationSpeed(double speed, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        if (speed == animationSpeed || speed <= 0)
+            return;
+        
+        anchorColumn = wrapColumn(columnAt(now));
+        anchorTime = now;
+        animationSpeed = speed;
+    }
+    
+    /**
+     * Gets the animation speed
+     * @return Milliseconds per column
+     */
+    double getAnimationSpeed() const
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        return animationSpeed;
+    }
+    
+    /**
+     * Sets which way the text travels; it carries on from where it is at that moment.
+     * Ignored while the text is streamed, since only what lies ahead of the left edge is read.
+     * @param direction MARQUEE_LEFT or MARQUEE_RIGHT
+     * @param now Current time
+     */
+    void setDirection(int direction, std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        if (direction == this->direction || source.isOpen())
+            return;
+        
+        anchorColumn = wrapColumn(columnAt(now));
+        anchorTime = now;
+        this->direction = direction;
+    }
+    
+    /**
+     * Gets which way the text travels
+     * @return MARQUEE_LEFT or MARQUEE_RIGHT
+     */
+    int getDirection() const
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        return direction;
+    }
+    
+    /**
+     * Continues scrolling from the current position, as of a given time.
+     * Called when the animation resumes so the time it was stopped is not counted.
+     * @param now Current time
+     */
+    void resume(std::chrono::steady_clock::time_point now)
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        anchorColumn = scrollPosition;
+        anchorTime = now;
+        lastUpdate = now;
     }
     
     /**
@@ -197,7 +368,6 @@ public:
     {
         std::lock_guard<std::mutex> lock(textMutex);
         isScrolling = true;
-        needsUpdate = true;
     }
     
     /**
@@ -226,209 +396,349 @@ public:
     void setAsciiArtMode(bool enabled)
     {
         std::lock_guard<std::mutex> lock(textMutex);
-        useAsciiArt = enabled && fileReader != nullptr;
-        needsUpdate = true;
+        useAsciiArt = enabled && font != nullptr;
+        rasterizeStrip();
     }
     
     /**
-     * Get the current display as vector of strings
-     * @return Vector of strings representing the current marquee display
+     * Switches to another font, or to plain text; the marquee becomes as tall as the font
+     * @param font Shared font from FontCache, nullptr for plain text one row high (as is a font without glyphs)
      */
-    std::vector<std::string> getCurrentDisplay()
+    void setFont(std::shared_ptr<const FileReader> font)
     {
         std::lock_guard<std::mutex> lock(textMutex);
+        this->font = font;
+        useAsciiArt = font && !font->getLoadedKeys().empty();
+        displayHeight = useAsciiArt ? std::max(1, std::min(font->getLineHeight(), 100)) : 1;
+        rasterizeStrip();
+    }
+    
+    /**
+     * Gets the number of rows drawInto() draws
+     */
+    int getHeight() const
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        return displayHeight;
+    }
+
+private:
+    /**
+     * Gets the strip column the marquee has reached at a given time, before wrapping
+     */
+    double columnAt(std::chrono::steady_clock::time_point now) const
+    {
+        double elapsed = std::max(0.0, std::chrono::duration<double, std::milli>(now - anchorTime).count());
         
-        std::vector<std::string> display;
-        for (int row = 0; row < displayHeight; row++)
-        {
-            std::string line;
-            for (int col = 0; col < displayWidth; col++)
-            {
-                line += displayBuffer[row][col];
-            }
-            display.push_back(line);
-        }
+        // The epsilon keeps a tick landing exactly on a column boundary from rounding down
+        return anchorColumn + direction * elapsed / animationSpeed + 1e-9;
+    }
+    
+    /**
+     * Wraps a strip column, which runs negative when scrolling right, into [0, stripWidth).
+     * Stream columns never wrap.
+     */
+    double wrapColumn(double column) const
+    {
+        if (source.isOpen())
+            return column;
         
-        return display;
+        double wrapped = std::fmod(column, (double)std::max(1, stripWidth));
+        return wrapped < 0 ? wrapped + std::max(1, stripWidth) : wrapped;
     }
     
     /**
-     * Get a single line of the current display (for simple marquee)
-     * @return Single string with the current marquee line
+     * Copies a window of one glyph strip row into a row of cells, wrapping around
+     * to the start of the strip (repeatedly if the strip is narrower than the window)
+     * @param row Strip row to copy from
+     * @param startCol Strip column shown at the left edge of the window
+     * @param out Cells to fill
+     * @param width Number of cells to fill
      */
-    std::string getCurrentLine()
+    void copyStripRow(int row, int startCol, char* out, int width) const
     {
-        std::vector<std::string> display = getCurrentDisplay();
-        if (!display.empty())
+        const char* stripRow = &glyphStrip[row * stripWidth];
+        
+        int col = 0;
+        int source = startCol % stripWidth;
+        while (col < width)
         {
-            // Return the middle line for single-line marquee
-            int middleLine = displayHeight / 2;
-            if (middleLine < display.size())
-            {
-                return display[middleLine];
-            }
+            int length = std::min(stripWidth - source, width - col);
+            std::copy(stripRow + source, stripRow + source + length, out + col);
+            col += length;
+            source = 0;
         }
-        return "";
     }
-
-private:
+    
     /**
-     * Initialize the display buffer
+     * Renders the current text plus wrap padding into the glyph strip.
+     * Called whenever the text or the rendering mode changes, never per tick.
      */
-    void initializeDisplayBuffer()
+    void rasterizeStrip()
     {
-        // Safety check for valid dimensions
-        if (displayHeight <= 0 || displayWidth <= 0 || 
-            displayHeight > 100 || displayWidth > 1000) {
-            // Use safe default values
-            displayHeight = 6;
-            displayWidth = 80;
+        if (source.isOpen())
+        {
+            resetStream();
+            return;
+        }
+        
+        if (currentText.empty())
+        {
+            glyphStrip.clear();
+            stripWidth = 0;
+            return;
         }
         
-        displayBuffer.clear();
-        try {
-            displayBuffer.resize(displayHeight);
+        std::string scrollText = currentText + WRAP_PADDING;
+        
+        if (useAsciiArt && font)
+        {
+            rasterizeAsciiArt(scrollText);
+        }
+        else
+        {
+            rasterizePlainText(scrollText);
+        }
+    }
+    
+    /**
+     * Stops streaming and lets the column window go
+     */
+    void closeSource()
+    {
+        source.close();
+        streamColumns = std::vector<char>();
+        readBuffer = std::string();
+        readOffset = 0;
+    }
+    
+    /**
+     * Starts the column window over at the current position, e.g. for another font.
+     * Columns already rasterized are dropped; bytes read but not rasterized carry on.
+     */
+    void resetStream()
+    {
+        streamCapacity = displayWidth + 2 * STREAM_LOOKAHEAD;
+        streamColumns.assign((std::size_t)streamCapacity * displayHeight, ' ');
+        windowStart = scrollPosition;
+        windowEnd = scrollPosition;
+    }
+    
+    /**
+     * Drops the columns left of the display and rasterizes ahead of it for as long as
+     * the source has text available, up to STREAM_LOOKAHEAD columns past the right edge
+     */
+    void fillStream()
+    {
+        windowStart = std::max(windowStart, scrollPosition);
+        windowEnd = std::max(windowEnd, windowStart);
+        
+        long long target = scrollPosition + displayWidth + STREAM_LOOKAHEAD;
+        while (windowEnd < target)
+        {
+            if (readOffset == readBuffer.size() && !readSource())
+                break;
             
-            for (int row = 0; row < displayHeight; row++)
+            char c = readBuffer[readOffset];
+            if (c == '\n')
+            {
+                // Line breaks become the same gap as the one between the end and the start of a text
+                for (const char* pad = WRAP_PADDING; *pad; pad++)
+                {
+                    appendColumns(*pad);
+                }
+            }
+            else if (c != '\r')
             {
-                displayBuffer[row].resize(displayWidth, ' ');
+                appendColumns((unsigned char)c < ' ' ? ' ' : c);
             }
-        } catch (const std::exception& e) {
-            // If resize fails, create minimal buffer
-            displayBuffer.clear();
-            displayBuffer.resize(1);
-            displayBuffer[0].resize(1, ' ');
-            displayHeight = 1;
-            displayWidth = 1;
+            readOffset++;
         }
     }
     
     /**
-     * Clear the display buffer
+     * Refills the read buffer with whatever the source has available
+     * @return False if it has nothing right now
      */
-    void clearDisplayBuffer()
+    bool readSource()
     {
-        for (int row = 0; row < displayHeight; row++)
+        readBuffer.resize(STREAM_READ_SIZE);
+        readOffset = 0;
+        
+        int count = source.read(&readBuffer[0], STREAM_READ_SIZE);
+        if (count == TEXT_SOURCE_END)
         {
-            for (int col = 0; col < displayWidth; col++)
+            // An empty file has nothing to show, however often it starts over
+            if (bytesSinceRewind == 0)
             {
-                displayBuffer[row][col] = ' ';
+                readBuffer.clear();
+                return false;
             }
+            
+            source.rewind();
+            bytesSinceRewind = 0;
+            if (endedWithBreak)
+                return readSource();
+            
+            readBuffer = "\n";  // Wrap padding before the file starts over
+            endedWithBreak = true;
+            return true;
+        }
+        
+        readBuffer.resize(count);
+        bytesSinceRewind += count;
+        if (count > 0)
+        {
+            endedWithBreak = readBuffer[count - 1] == '\n';
         }
+        return count > 0;
     }
     
     /**
-     * Update the display buffer with current text and scroll position
+     * Rasterizes one character at the end of the column window. If the window had run dry
+     * and fallen behind the right edge, blank columns take it there first, so the text
+     * comes in from the right instead of appearing in the middle of the display.
+     * @param c Character to add, without control characters
      */
-    void updateDisplayBuffer()
+    void appendColumns(char c)
     {
-        clearDisplayBuffer();
-        
-        if (currentText.empty())
+        long long rightEdge = scrollPosition + displayWidth;
+        while (windowEnd < rightEdge)
         {
-            return;
+            fillStreamColumn(windowEnd++, nullptr, 0);
         }
         
-        if (useAsciiArt && fileReader)
+        if (!useAsciiArt || !font)
         {
-            renderAsciiArt();
+            fillStreamColumn(windowEnd++, &c, 0);
+            return;
         }
-        else
+        
+        int width = measureGlyph(c);
+        bool hasArt = c != ' ' && font->hasArt(c);
+        for (int col = 0; col < width + GLYPH_SPACING; col++)
         {
-            renderPlainText();
+            fillStreamColumn(windowEnd++, hasArt && col < width ? &c : nullptr, col);
         }
     }
     
     /**
-     * Render text using ASCII art characters
+     * Writes one column of the window
+     * @param column Stream column to write
+     * @param c Character the column belongs to, nullptr for a blank column
+     * @param glyphCol Column within the character's ASCII art
      */
-    void renderAsciiArt()
+    void fillStreamColumn(long long column, const char* c, int glyphCol)
     {
-        // Create a continuous text loop with minimal padding
-        std::string scrollText = currentText + "   "; // Only 3 spaces padding
-        int totalLength = scrollText.length();
-        
-        // Calculate which characters are visible
-        std::vector<char> visibleChars;
-        for (int i = 0; i < displayWidth; i++)
+        char* cell = &streamColumns[column % streamCapacity];
+        for (int row = 0; row < displayHeight; row++, cell += streamCapacity)
         {
-            int textIndex = (scrollPosition + i) % totalLength;
-            visibleChars.push_back(scrollText[textIndex]);
+            if (!c)
+            {
+                *cell = ' ';
+            }
+            else if (!useAsciiArt || !font)
+            {
+                *cell = *c;  // Plain text repeats on every row
+            }
+            else
+            {
+                std::string_view art = row < font->getGlyphHeight(*c) ? font->glyphRow(*c, row) : std::string_view();
+                *cell = glyphCol < (int)art.size() ? art[glyphCol] : ' ';
+            }
         }
+        windowStart = std::max(windowStart, column + 1 - streamCapacity);
+    }
+    
+    /**
+     * Copies one row of the column window into a row of cells, starting at the scroll position;
+     * columns outside the window are blank
+     * @param row Row to copy from
+     * @param out Cells to fill
+     * @param width Number of cells to fill
+     */
+    void copyStreamRow(int row, char* out, int width) const
+    {
+        std::fill(out, out + width, ' ');
         
-        // Render each character using ASCII art
-        int charWidth = 8;  // Assume each ASCII character is 8 columns wide
-        int charsPerLine = displayWidth / charWidth;
+        long long first = std::max(windowStart, scrollPosition);
+        long long last = std::min(windowEnd, scrollPosition + width);
+        const char* streamRow = &streamColumns[(std::size_t)row * streamCapacity];
         
-        for (int charIndex = 0; charIndex < charsPerLine && charIndex < visibleChars.size(); charIndex++)
+        // The visible columns wrap around the end of the ring at most once
+        for (long long column = first; column < last;)
         {
-            char c = visibleChars[charIndex];
-            if (c != ' ' && fileReader->hasArt(c))
-            {
-                std::vector<std::string> art = fileReader->lookupArt(c);
-                
-                // Place ASCII art in display buffer starting from top (row 0)
-                for (int row = 0; row < std::min((int)art.size(), displayHeight); row++)
-                {
-                    int startCol = charIndex * charWidth;
-                    for (int col = 0; col < std::min((int)art[row].length(), charWidth); col++)
-                    {
-                        if (startCol + col < displayWidth)
-                        {
-                            displayBuffer[row][startCol + col] = art[row][col];
-                        }
-                    }
-                }
-            }
+            int slot = (int)(column % streamCapacity);
+            int length = (int)std::min<long long>(streamCapacity - slot, last - column);
+            std::copy(streamRow + slot, streamRow + slot + length, out + (column - scrollPosition));
+            column += length;
         }
     }
     
     /**
-     * Render text as plain characters (fallback mode) - FIXED VERSION
+     * Render text using ASCII art characters, each as wide as its widest row
+     * @param scrollText Text including wrap padding
      */
-    void renderPlainText()
+    void rasterizeAsciiArt(const std::string& scrollText)
     {
-        // Create a continuous text loop with minimal padding
-        std::string scrollText = currentText + "   "; // Only 3 spaces padding
-        int totalLength = scrollText.length();
+        // First pass measures every glyph so the strip is allocated once
+        std::vector<int> glyphWidths(scrollText.length());
+        stripWidth = 0;
+        for (std::size_t charIndex = 0; charIndex < scrollText.length(); charIndex++)
+        {
+            glyphWidths[charIndex] = measureGlyph(scrollText[charIndex]) + GLYPH_SPACING;
+            stripWidth += glyphWidths[charIndex];
+        }
         
-        // Fill all rows with the scrolling text (not just middle row)
-        for (int row = 0; row < displayHeight; row++)
+        glyphStrip.assign(displayHeight * stripWidth, ' ');
+        
+        int startCol = 0;
+        for (std::size_t charIndex = 0; charIndex < scrollText.length(); charIndex++)
         {
-            for (int col = 0; col < displayWidth; col++)
+            char c = scrollText[charIndex];
+            if (c != ' ' && font->hasArt(c))
             {
-                int textIndex = (scrollPosition + col) % totalLength;
-                displayBuffer[row][col] = scrollText[textIndex];
+                // Place ASCII art in the strip starting from top (row 0)
+                int height = std::min(font->getGlyphHeight(c), displayHeight);
+                for (int row = 0; row < height; row++)
+                {
+                    std::string_view art = font->glyphRow(c, row);
+                    std::copy(art.begin(), art.end(), glyphStrip.begin() + row * stripWidth + startCol);
+                }
             }
+            
+            startCol += glyphWidths[charIndex];
         }
     }
     
     /**
-     * Rotate/shift logic (converted from original C function)
-     * @param row Pointer to row array
-     * @param cols Number of columns
+     * Measures the width of a character's ASCII art
+     * @param c Character to measure
+     * @return Width of the glyph, ASCII_SPACE_WIDTH for spaces and characters without art
      */
-    void rotateLeft(std::vector<char>& row)
+    int measureGlyph(char c)
     {
-        if (row.size() <= 1) return;
-        
-        char first = row[0];
-        for (size_t j = 0; j < row.size() - 1; j++)
+        if (c == ' ' || !font->hasArt(c))
         {
-            row[j] = row[j + 1];
+            return ASCII_SPACE_WIDTH;
         }
-        row[row.size() - 1] = first;
+        
+        return font->getGlyphWidth(c);
     }
     
     /**
-     * Apply marquee logic to entire display buffer
-     * (converted from original marqueeLogic function)
+     * Render text as plain characters (fallback mode), repeated on every row
+     * @param scrollText Text including wrap padding
      */
-    void applyMarqueeLogic()
+    void rasterizePlainText(const std::string& scrollText)
     {
+        stripWidth = scrollText.length();
+        glyphStrip.resize(displayHeight * stripWidth);
+        
+        // Fill all rows with the scrolling text (not just middle row)
         for (int row = 0; row < displayHeight; row++)
         {
-            rotateLeft(displayBuffer[row]);
+            std::copy(scrollText.begin(), scrollText.end(), glyphStrip.begin() + row * stripWidth);
         }
     }
     
@@ -440,16 +750,23 @@ private:
         std::lock_guard<std::mutex> lock(textMutex);
         
         std::string info = "MarqueeLogicHandler Status:\n";
-        info += " - Text: \"" + currentText + "\"\n";
+        if (source.isOpen())
+        {
+            info += " - Text Source: " + source.getPath() + "\n";
+        }
+        else
+        {
+            info += " - Text: \"" + currentText + "\"\n";
+        }
         info += " - Scroll Position: " + std::to_string(scrollPosition) + "\n";
         info += " - Animation Speed: " + std::to_string(animationSpeed) + "ms\n";
         info += " - Is Scrolling: " + std::string(isScrolling ? "Yes" : "No") + "\n";
         info += " - ASCII Art Mode: " + std::string(useAsciiArt ? "Enabled" : "Disabled") + "\n";
         info += " - Display Size: " + std::to_string(displayWidth) + "x" + std::to_string(displayHeight) + "\n";
         
-        if (fileReader)
+        if (font)
         {
-            std::vector<char> loadedKeys = fileReader->getLoadedKeys();
+            std::vector<char> loadedKeys = font->getLoadedKeys();
             info += " - Loaded ASCII Characters: " + std::to_string(loadedKeys.size()) + "\n";
         }
         
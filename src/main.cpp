@@ -1,10 +1,270 @@
 #include "ConsoleController.cpp"
+#include "utils/OffscreenTerminal.cpp"
+#include "utils/LatencyStats.cpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
 
-int main()
+/**
+ * Options for a headless run, taken from the command line
+ */
+typedef struct HeadlessOptionsStruct
 {
-  ConsoleController console;
+  long long frames = 1000;   // Number of frames to render
+  int width = 120;           // Offscreen terminal size
+  int height = 30;
+  std::set<long long> dump;  // Frame numbers to save as text
+  std::string dumpDir = "."; // Folder the dumped frames go to
+  std::string scriptPath;    // Command script to replay instead of a fixed number of frames
+  int lanes = 0;             // Marquee lanes added below the main one
+  int threads = -1;          // Threads that help draw large frames, -1 for one less than the number of cores
+} HeadlessOptions;
+
+/**
+ * Builds the commands that add benchmark lanes: one row of plain text each,
+ * with a spread of speeds and every other lane scrolling right
+ * @param count Number of lanes to add
+ * @return Commands to run before the first frame
+ */
+std::vector<std::string> laneCommands(int count)
+{
+  std::vector<std::string> commands;
+  for (int i = 1; i <= count; i++)
+  {
+    std::string name = "lane" + std::to_string(i);
+    commands.push_back("lane add " + name);
+    commands.push_back("lane set " + name + " font plain");
+    commands.push_back("lane set " + name + " text Lane " + std::to_string(i) + " headline, departures and alerts");
+    commands.push_back("lane set " + name + " speed " + std::to_string(10 + i % 7 * 15));
+    if (i % 2 == 0)
+      commands.push_back("lane set " + name + " direction right");
+  }
+  return commands;
+}
+
+/**
+ * Reads a replay script: one command per line, optionally prefixed with "@<ms> " to run it
+ * that many milliseconds into the run. A line holding only "@<ms>" waits without a command.
+ * Blank lines and lines starting with '#' are skipped.
+ * @param path Script file
+ * @param script Receives the lines
+ * @return False if the file could not be read or a timestamp is malformed
+ */
+bool loadScript(const std::string &path, std::vector<ScriptLine> &script)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    std::cerr << "Could not read " << path << std::endl;
+    return false;
+  }
+
+  std::string line;
+  long long lastMs = 0;
+  int lineNumber = 0;
+
+  while (std::getline(file, line))
+  {
+    lineNumber++;
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    ScriptLine entry;
+    entry.atMs = lastMs; // Untimed lines run as soon as the line before them
+
+    if (line[0] == '@')
+    {
+      char *end = nullptr;
+      entry.atMs = std::strtoll(line.c_str() + 1, &end, 10);
+      if (end == line.c_str() + 1 || (*end != '\0' && *end != ' ') || entry.atMs < 0)
+      {
+        std::cerr << path << ":" << lineNumber << ": expected @<milliseconds>" << std::endl;
+        return false;
+      }
+      entry.atMs = std::max(entry.atMs, lastMs);
+
+      size_t start = line.find_first_not_of(' ', end - line.c_str());
+      line = start == std::string::npos ? "" : line.substr(start);
+    }
+
+    entry.command = line;
+    lastMs = entry.atMs;
+    script.push_back(entry);
+  }
+  return true;
+}
+
+/**
+ * Renders frames into an offscreen terminal, or replays a script into one, and prints throughput statistics
+ * @param options Parsed command line options
+ * @return Process exit code
+ */
+int runHeadless(const HeadlessOptions &options)
+{
+  std::vector<ScriptLine> script;
+  if (!options.scriptPath.empty() && !loadScript(options.scriptPath, script))
+    return 1;
+
+  OffscreenTerminal *screen = new OffscreenTerminal(options.width, options.height);
+  ConsoleController console(screen, options.threads); // Takes ownership of the screen
+
+  bool dumpFailed = false;
+  auto onFrame = [&](long long frame)
+  {
+    if (options.dump.count(frame) == 0)
+      return;
+
+    std::string path = options.dumpDir + "/frame_" + std::to_string(frame) + ".txt";
+    std::ofstream file(path, std::ios::binary);
+    file << screen->snapshot();
+    if (!file)
+    {
+      std::cerr << "Could not write " << path << std::endl;
+      dumpFailed = true;
+    }
+  };
+
+  auto begin = std::chrono::steady_clock::now();
+  long long commands = 0;
+
+  if (options.scriptPath.empty())
+    console.runHeadless(options.frames, onFrame, laneCommands(options.lanes));
+  else
+    commands = console.runScript(script, onFrame);
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+  long long frames = console.getFramesRendered();
+
+  std::vector<double> frameTimes = console.getFrameTimes();
+  std::sort(frameTimes.begin(), frameTimes.end());
+
+  if (!options.scriptPath.empty())
+  {
+    std::cout << "Commands run:    " << commands << std::endl;
+    std::cout << "Commands/sec:    " << (seconds > 0 ? commands / seconds : 0) << std::endl;
+  }
+  std::cout << "Frames rendered: " << frames << std::endl;
+  std::cout << "Render threads:  " << console.getRenderThreads() << " helping" << std::endl;
+  std::cout << "Elapsed time:    " << seconds << " s" << std::endl;
+  std::cout << "Frames/sec:      " << (seconds > 0 ? frames / seconds : 0) << std::endl;
+  std::cout << "Frame time (us): p50 " << LatencyStats::percentile(frameTimes, 0.5) << ", p90 " << LatencyStats::percentile(frameTimes, 0.9)
+            << ", p99 " << LatencyStats::percentile(frameTimes, 0.99) << ", max " << (frameTimes.empty() ? 0 : frameTimes.back()) << std::endl;
+  if (options.lanes > 0)
+  {
+    int lanes = options.lanes + 1; // The main lane as well
+    std::cout << "Lanes:           " << lanes << " (p50 " << LatencyStats::percentile(frameTimes, 0.5) / lanes << " us per lane)" << std::endl;
+  }
+  std::cout << "Bytes written:   " << screen->getBytesWritten()
+            << " (" << (frames > 0 ? screen->getBytesWritten() / frames : 0) << " per frame)" << std::endl;
+  std::cout << "Flushes:         " << screen->getFlushCount() << std::endl;
+
+  return dumpFailed ? 1 : 0;
+}
+
+/**
+ * Prints the command line usage
+ */
+void printUsage(const char *program)
+{
+  std::cerr << "Usage: " << program << " [--control-socket PATH] [--threads N]" << std::endl;
+  std::cerr << "       " << program << " --headless [--frames N] [--size WxH] [--lanes N] [--threads N] [--dump N,M,...] [--dump-dir DIR]" << std::endl;
+  std::cerr << "       " << program << " --script FILE [--size WxH] [--threads N] [--dump N,M,...] [--dump-dir DIR]" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  bool headless = false;
+  HeadlessOptions options;
+  std::string controlSocketPath;
+
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if (arg == "--headless")
+    {
+      headless = true;
+    }
+    else if (arg == "--frames" && hasValue)
+    {
+      options.frames = std::atoll(argv[++i]);
+    }
+    else if (arg == "--size" && hasValue)
+    {
+      if (std::sscanf(argv[++i], "%dx%d", &options.width, &options.height) != 2 || options.width <= 0 || options.height <= 0)
+      {
+        printUsage(argv[0]);
+        return 2;
+      }
+    }
+    else if (arg == "--lanes" && hasValue)
+    {
+      options.lanes = std::atoi(argv[++i]);
+      if (options.lanes < 0 || options.lanes >= MAX_LANES)
+      {
+        printUsage(argv[0]);
+        return 2;
+      }
+    }
+    else if (arg == "--threads" && hasValue)
+    {
+      options.threads = std::atoi(argv[++i]);
+      if (options.threads < 0)
+      {
+        printUsage(argv[0]);
+        return 2;
+      }
+    }
+    else if (arg == "--dump" && hasValue)
+    {
+      std::stringstream list(argv[++i]);
+      std::string frame;
+      while (std::getline(list, frame, ','))
+      {
+        options.dump.insert(std::atoll(frame.c_str()));
+      }
+    }
+    else if (arg == "--dump-dir" && hasValue)
+    {
+      options.dumpDir = argv[++i];
+    }
+    else if (arg == "--script" && hasValue)
+    {
+      headless = true; // Scripts always replay offscreen
+      options.scriptPath = argv[++i];
+    }
+    else if (arg == "--control-socket" && hasValue)
+    {
+      controlSocketPath = argv[++i];
+    }
+    else
+    {
+      printUsage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (headless)
+  {
+    return runHeadless(options);
+  }
+
+  ConsoleController console(nullptr, options.threads);
+
+  if (!controlSocketPath.empty() && !console.enableControlSocket(controlSocketPath))
+  {
+    std::cerr << "Could not open control socket " << controlSocketPath << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
 
   console.start();
 
   return 0;
-}
\ No newline at end of file
+}
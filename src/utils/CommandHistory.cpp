@@ -1,25 +1,260 @@
-#include <queue>
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <fstream>
 #include <string>
-#include <iostream>
+#include <unordered_map>
+#include "RingBuffer.cpp"
+
+// Commands kept in memory; older ones are forgotten
+#define HISTORY_CAPACITY 50000
+
+// File the history is kept in between runs, relative to the working directory
+#define HISTORY_FILE ".marquee_history"
 
+// Commands written to the file per flush; the rest go out on exit
+#define HISTORY_FLUSH_LINES 16
+
+/**
+ * CommandHistory - Previously entered commands, saved to a file and searchable
+ *
+ * Commands live in a RingBuffer, so adding one is O(1) however full the
+ * history is. Every command gets a sequence number that only grows, which
+ * lets the search index refer to commands without being rewritten when old
+ * ones drop out. The index maps each three-character substring (trigram) to
+ * the commands containing it, so a search only looks at commands that share
+ * the query's rarest trigram instead of scanning everything.
+ *
+ * The file is read on first use rather than at construction, so startup does
+ * not wait for it, and new commands are appended to it in small batches.
+ */
 class CommandHistory
 {
 private:
-    std::vector<std::string> history;
-    int rowHeight;
+    RingBuffer<std::string> entries;
+    uint64_t nextSequence;  // Sequence of the next command added; entry i is nextSequence - size() + i
+
+    // Trigram -> sequences of the commands containing it, oldest first.
+    // Sequences of forgotten commands are dropped from the front as lists are used.
+    std::unordered_map<uint32_t, std::deque<uint64_t>> trigramIndex;
+
+    std::string path;
+    bool loaded;
+    std::ofstream file;
+    int unflushedLines;
 
 public:
-    CommandHistory(int rowHeight = 50) : rowHeight(rowHeight) {}
+    /**
+     * Constructor for CommandHistory
+     * @param path History file; empty to keep the history in memory only
+     * @param capacity Most commands kept
+     */
+    CommandHistory(const std::string& path = HISTORY_FILE, std::size_t capacity = HISTORY_CAPACITY)
+        : entries(capacity)
+    {
+        this->path = path;
+        nextSequence = 0;
+        loaded = false;
+        unflushedLines = 0;
+    }
+
+    ~CommandHistory()
+    {
+        if (file.is_open())
+        {
+            file.flush();
+        }
+    }
+
+    /**
+     * Records a command, unless it repeats the newest one
+     * @param command Command as typed
+     */
+    void add(const std::string& command)
+    {
+        ensureLoaded();
+        if (command.empty() || (!entries.empty() && entries.back() == command))
+            return;
+
+        remember(command);
+
+        if (!path.empty())
+        {
+            if (!file.is_open())
+            {
+                file.open(path, std::ios::app);
+            }
+            file << command << '\n';
+
+            if (++unflushedLines >= HISTORY_FLUSH_LINES)
+            {
+                file.flush();
+                unflushedLines = 0;
+            }
+        }
+    }
+
+    /**
+     * Number of commands kept
+     */
+    std::size_t size()
+    {
+        ensureLoaded();
+        return entries.size();
+    }
+
+    /**
+     * Gets a command, 0 being the oldest kept
+     */
+    const std::string& get(std::size_t index)
+    {
+        ensureLoaded();
+        return entries[index];
+    }
+
+    /**
+     * Finds the newest command older than a given one that contains the query
+     * @param query Text to look for; an empty query matches every command
+     * @param before Only commands with a smaller index are considered; size() searches everything
+     * @return Index of the match, or -1 if there is none
+     */
+    long long search(const std::string& query, std::size_t before)
+    {
+        ensureLoaded();
+        before = std::min(before, entries.size());
+        uint64_t firstSequence = nextSequence - entries.size();
+
+        if (query.length() < 3)
+        {
+            // Too short to have a trigram; short queries match recent commands quickly anyway
+            for (std::size_t i = before; i-- > 0;)
+            {
+                if (entries[i].find(query) != std::string::npos)
+                    return (long long)i;
+            }
+            return -1;
+        }
+
+        // Only commands containing every trigram of the query can match; walk the shortest list
+        std::deque<uint64_t>* candidates = nullptr;
+        for (std::size_t i = 0; i + 3 <= query.length(); i++)
+        {
+            auto found = trigramIndex.find(trigram(query, i));
+            if (found == trigramIndex.end())
+                return -1;
+
+            std::deque<uint64_t>& sequences = found->second;
+            while (!sequences.empty() && sequences.front() < firstSequence)
+            {
+                sequences.pop_front();
+            }
+            if (!candidates || sequences.size() < candidates->size())
+            {
+                candidates = &sequences;
+            }
+        }
+
+        uint64_t limit = firstSequence + before;
+        auto end = std::lower_bound(candidates->begin(), candidates->end(), limit);
+        while (end != candidates->begin())
+        {
+            --end;
+            std::size_t index = (std::size_t)(*end - firstSequence);
+            if (entries[index].find(query) != std::string::npos)
+                return (long long)index;
+        }
+        return -1;
+    }
+
+private:
+    /**
+     * Packs the three characters at a position into one key
+     */
+    static uint32_t trigram(const std::string& text, std::size_t position)
+    {
+        return ((uint32_t)(unsigned char)text[position] << 16) |
+               ((uint32_t)(unsigned char)text[position + 1] << 8) |
+               (uint32_t)(unsigned char)text[position + 2];
+    }
 
-    void addCommand(const std::string &command)
+    /**
+     * Adds a command to the ring and the index
+     */
+    void remember(const std::string& command)
     {
-        if (history.size() >= rowHeight)
-            history.erase(history.begin());
-        history.push_back(command);
+        uint64_t sequence = nextSequence++;
+        entries.push(command);
+
+        // Each time the ring has turned over, drop what the forgotten commands left in the index
+        if (sequence > 0 && sequence % entries.capacity() == 0)
+        {
+            pruneIndex();
+        }
+
+        for (std::size_t i = 0; i + 3 <= command.length(); i++)
+        {
+            std::deque<uint64_t>& sequences = trigramIndex[trigram(command, i)];
+            if (sequences.empty() || sequences.back() != sequence)
+            {
+                sequences.push_back(sequence);
+            }
+        }
     }
 
-    std::vector<std::string> getHistory() const
+    /**
+     * Removes forgotten commands from every trigram list, and lists left empty
+     */
+    void pruneIndex()
     {
-        return history;
+        uint64_t firstSequence = nextSequence - entries.size();
+
+        for (auto it = trigramIndex.begin(); it != trigramIndex.end();)
+        {
+            std::deque<uint64_t>& sequences = it->second;
+            while (!sequences.empty() && sequences.front() < firstSequence)
+            {
+                sequences.pop_front();
+            }
+            it = sequences.empty() ? trigramIndex.erase(it) : std::next(it);
+        }
+    }
+
+    /**
+     * Reads the history file the first time the history is used
+     */
+    void ensureLoaded()
+    {
+        if (loaded)
+            return;
+        loaded = true;
+
+        if (path.empty())
+            return;
+
+        std::ifstream input(path);
+        std::string line;
+        std::size_t linesRead = 0;
+
+        while (std::getline(input, line))
+        {
+            linesRead++;
+            if (!line.empty() && (entries.empty() || entries.back() != line))
+            {
+                remember(line);
+            }
+        }
+        input.close();
+
+        // The file is only ever appended to; once it holds far more than is kept, rewrite it
+        if (linesRead > entries.capacity() * 2)
+        {
+            std::ofstream output(path, std::ios::trunc);
+            for (std::size_t i = 0; i < entries.size(); i++)
+            {
+                output << entries[i] << '\n';
+            }
+        }
     }
 };
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include "Terminal.cpp"
+
+/**
+ * FixedStepClock - Schedules ticks on a fixed grid so lateness never builds up
+ *
+ * Each tick moves the next deadline on by exactly one period from the
+ * previous deadline, not from whenever the tick actually ran, so a late
+ * wake-up is made up by the following ticks instead of shifting all of them.
+ * A caller that fell too far behind can skip the missed ticks whole, which
+ * drops them without moving the grid off wall-clock time.
+ */
+class FixedStepClock
+{
+private:
+    Deadline nextTick;
+
+public:
+    FixedStepClock()
+    {
+        nextTick = Deadline();
+    }
+
+    /**
+     * Starts the grid over, with the first tick at a given time
+     * @param firstTick When the next tick is due
+     */
+    void reset(Deadline firstTick)
+    {
+        nextTick = firstTick;
+    }
+
+    /**
+     * Gets when the next tick is due
+     */
+    Deadline next() const
+    {
+        return nextTick;
+    }
+
+    /**
+     * Checks whether a tick is due
+     * @param now Current time
+     */
+    bool isDue(Deadline now) const
+    {
+        return now >= nextTick;
+    }
+
+    /**
+     * Takes one tick, scheduling the next one a period after this one's deadline
+     * @param period Time until the next tick; must be positive
+     */
+    void step(std::chrono::nanoseconds period)
+    {
+        nextTick += period;
+    }
+
+    /**
+     * Drops every tick that is due, keeping the grid: the next tick is the first one after now
+     * @param now Current time
+     * @param period Tick period; must be positive
+     * @return Number of ticks dropped
+     */
+    long long skipMissed(Deadline now, std::chrono::nanoseconds period)
+    {
+        if (now < nextTick)
+            return 0;
+
+        long long missed = (now - nextTick) / period + 1;
+        nextTick += missed * period;
+        return missed;
+    }
+};
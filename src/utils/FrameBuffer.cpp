@@ -0,0 +1,210 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/**
+ * A block of cells in row-major order, as handed from one handler to another
+ */
+typedef struct CellGridStruct
+{
+    int width;
+    int height;
+    std::vector<char> cells;  // width * height characters
+} CellGrid;
+
+/**
+ * FrameBuffer - Front/back character grid for flicker-free console output
+ *
+ * Display sections draw into the back buffer. flush() compares the back
+ * buffer against the front buffer (what is currently on screen) and emits
+ * only the runs of cells that changed.
+ */
+class FrameBuffer
+{
+private:
+    int width;
+    int height;
+
+    std::vector<char> frontBuffer;  // Mirror of what is on the console
+    std::vector<char> backBuffer;   // Frame currently being composed
+
+    // Unchanged cells shorter than this between two changes are re-sent
+    // instead of starting a new run (a cursor move costs more than a few bytes)
+    static const int RUN_MERGE_GAP = 4;
+
+public:
+    /**
+     * Constructor for FrameBuffer
+     * @param width Number of columns
+     * @param height Number of rows
+     */
+    FrameBuffer(int width = 0, int height = 0)
+    {
+        this->width = 0;
+        this->height = 0;
+        resize(width, height);
+    }
+
+    /**
+     * Resizes both buffers, discarding their contents
+     * @param width Number of columns
+     * @param height Number of rows
+     */
+    void resize(int width, int height)
+    {
+        this->width = std::max(0, width);
+        this->height = std::max(0, height);
+
+        frontBuffer.assign(this->width * this->height, ' ');
+        backBuffer.assign(this->width * this->height, ' ');
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    /**
+     * Sets a single cell in the back buffer, ignoring out of range cells
+     * @param x Column
+     * @param y Row
+     * @param c Character to place
+     */
+    void put(int x, int y, char c)
+    {
+        if (x < 0 || y < 0 || x >= width || y >= height)
+            return;
+
+        backBuffer[y * width + x] = c;
+    }
+
+    /**
+     * Writes text into the back buffer, clipped to the buffer and to a field width.
+     * If the text is shorter than the field, the rest of the field is blanked.
+     * @param x Starting column
+     * @param y Row
+     * @param text Text to write
+     * @param fieldWidth Width of the field to fill, -1 to write only the text
+     */
+    void write(int x, int y, const std::string& text, int fieldWidth = -1)
+    {
+        write(x, y, text.data(), (int)text.length(), fieldWidth);
+    }
+
+    /**
+     * Writes raw characters into the back buffer, see write(int, int, const std::string&, int)
+     */
+    void write(int x, int y, const char* text, int length, int fieldWidth = -1)
+    {
+        if (y < 0 || y >= height)
+            return;
+
+        if (fieldWidth < 0)
+            fieldWidth = length;
+
+        int end = std::min(x + fieldWidth, width);
+        char* row = &backBuffer[y * width];
+
+        for (int col = std::max(x, 0); col < end; col++)
+        {
+            int i = col - x;
+            row[col] = i < length ? text[i] : ' ';
+        }
+    }
+
+    /**
+     * Fills a horizontal span of the back buffer with one character
+     * @param x Starting column
+     * @param y Row
+     * @param length Number of cells
+     * @param c Fill character
+     */
+    void fill(int x, int y, int length, char c = ' ')
+    {
+        if (y < 0 || y >= height)
+            return;
+
+        int start = std::max(x, 0);
+        int end = std::min(x + length, width);
+        if (start < end)
+        {
+            std::fill(backBuffer.begin() + y * width + start, backBuffer.begin() + y * width + end, c);
+        }
+    }
+
+    /**
+     * Blanks the whole back buffer
+     */
+    void clear()
+    {
+        std::fill(backBuffer.begin(), backBuffer.end(), ' ');
+    }
+
+    /**
+     * Records that the physical screen was blanked outside of flush(),
+     * e.g. after a full console clear
+     */
+    void markScreenCleared()
+    {
+        std::fill(frontBuffer.begin(), frontBuffer.end(), ' ');
+    }
+
+    /**
+     * Forces every cell to be re-sent on the next flush
+     */
+    void invalidate()
+    {
+        std::fill(frontBuffer.begin(), frontBuffer.end(), '\0');
+    }
+
+    /**
+     * Sends the differences between the back and front buffers to the screen
+     * @param emit Callable invoked as emit(x, y, const char* text, int length) for each changed run
+     * @return Number of runs emitted
+     */
+    template <typename Emit>
+    int flush(Emit emit)
+    {
+        int runs = 0;
+
+        for (int y = 0; y < height; y++)
+        {
+            const char* back = &backBuffer[y * width];
+            char* front = &frontBuffer[y * width];
+
+            int x = 0;
+            while (x < width)
+            {
+                // Skip cells that are already on screen
+                while (x < width && back[x] == front[x])
+                    x++;
+                if (x >= width)
+                    break;
+
+                // Extend the run while changes keep appearing within the merge gap
+                int runStart = x;
+                int runEnd = x + 1;
+                int gap = 0;
+                for (x = runEnd; x < width && gap < RUN_MERGE_GAP; x++)
+                {
+                    if (back[x] != front[x])
+                    {
+                        runEnd = x + 1;
+                        gap = 0;
+                    }
+                    else
+                    {
+                        gap++;
+                    }
+                }
+
+                emit(runStart, y, back + runStart, runEnd - runStart);
+                std::copy(back + runStart, back + runEnd, front + runStart);
+                runs++;
+                x = runEnd;
+            }
+        }
+
+        return runs;
+    }
+};
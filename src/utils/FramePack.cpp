@@ -0,0 +1,471 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define FRAME_PACK_FILE "utils/data/frames.pack"
+#define FRAME_PACK_MAGIC "MQFP"
+#define FRAME_PACK_VERSION 2
+
+// Unchanged cells shorter than this between two changes are kept inside one run
+// (matches RUN_MERGE_GAP in pack_frames.py)
+#define FRAME_RUN_MERGE_GAP 6
+
+/**
+ * On-disk header of a frame pack, written by utils/data/pack_frames.py. It is followed by
+ *  - frameCount uint16 delays (milliseconds, 0 = follow the console speed)
+ *  - frameCount + 1 uint32 offsets of each frame's runs within the run section
+ *  - the keyframe (frame 0): height * width cells, row by row
+ *  - the run section: for each frame, the runs that turn the previous frame into it;
+ *    frame 0's runs turn the last frame back into frame 0 so the animation loops.
+ *    Each run is uint16 row, uint16 column, uint16 length, then length cells.
+ */
+typedef struct FramePackHeaderStruct
+{
+    char magic[4];
+    uint16_t version;
+    uint16_t reserved;
+    uint32_t frameCount;
+    uint16_t width;
+    uint16_t height;
+} FramePackHeader;
+
+/**
+ * Zero-copy reference to one frame's cells
+ */
+typedef struct FrameViewStruct
+{
+    const char* cells;  // height rows of width characters, nullptr for no frame
+    int width;
+    int height;
+} FrameView;
+
+/**
+ * FramePack - Delta-encoded animation served straight from one memory-mapped file
+ *
+ * Only the keyframe is stored whole; every other frame is the list of cell runs
+ * that changed since the frame before it, so playback touches just those cells.
+ * A directory of frame_NN.txt files can be loaded as a fallback; it is encoded
+ * into memory once and served the same way.
+ */
+class FramePack
+{
+private:
+    const char* data;            // Start of the mapped file, or of ownedData
+    std::size_t dataSize;
+    std::vector<char> ownedData; // Backing store when loaded from text files
+
+    int frameCount;
+    int width;
+    int height;
+    const char* delays;          // frameCount little-endian uint16 values
+    const char* runOffsets;      // frameCount + 1 little-endian uint32 values
+    const char* keyframe;        // width * height cells of frame 0
+    const char* runs;            // Start of the run section
+
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#endif
+    bool isMapped;
+
+public:
+    FramePack()
+    {
+        data = nullptr;
+        dataSize = 0;
+        isMapped = false;
+#ifdef _WIN32
+        fileHandle = INVALID_HANDLE_VALUE;
+        mappingHandle = NULL;
+#endif
+        reset();
+    }
+
+    ~FramePack()
+    {
+        unmap();
+    }
+
+    FramePack(const FramePack&) = delete;
+    FramePack& operator=(const FramePack&) = delete;
+
+    /**
+     * Memory-maps a frame pack file
+     * @param path Path of the .pack file
+     * @return True if the file was mapped and its header is valid
+     */
+    bool open(const std::string& path = FRAME_PACK_FILE)
+    {
+        unmap();
+
+#ifdef _WIN32
+        fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+
+        long long size = 0;
+        GetFileSizeEx(fileHandle, (PLARGE_INTEGER)&size);
+        mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+        void* view = mappingHandle ? MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0) : NULL;
+        if (!view)
+        {
+            unmap();
+            return false;
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+
+        struct stat info;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+        {
+            view = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);  // The mapping stays valid after the descriptor is closed
+
+        if (view == MAP_FAILED)
+            return false;
+
+        long long size = info.st_size;
+#endif
+
+        data = (const char*)view;
+        dataSize = size;
+        isMapped = true;
+
+        if (!parse())
+        {
+            unmap();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Loads frame_01.txt, frame_02.txt, ... from a directory until a file is missing
+     * @param directory Directory of ASCII frames, with trailing slash
+     * @return True if at least one frame was loaded
+     */
+    bool loadDirectory(const std::string& directory)
+    {
+        unmap();
+
+        std::vector<std::vector<std::string>> frames;
+        int maxWidth = 0;
+        int maxHeight = 0;
+
+        for (int i = 1; ; i++)
+        {
+            std::string number = std::to_string(i);
+            std::string filename = directory + "frame_" + std::string(number.length() < 2 ? 2 - number.length() : 0, '0') + number + ".txt";
+            std::ifstream file(filename);
+            if (!file.is_open())
+                break;
+
+            std::vector<std::string> frame;
+            std::string line;
+            while (std::getline(file, line))
+            {
+                maxWidth = std::max(maxWidth, (int)line.length());
+                frame.push_back(line);
+            }
+            maxHeight = std::max(maxHeight, (int)frame.size());
+            frames.push_back(frame);
+        }
+
+        if (frames.empty() || maxWidth == 0)
+            return false;
+
+        // Pad every frame to a full grid
+        std::vector<std::string> grids;
+        for (const std::vector<std::string>& frame : frames)
+        {
+            std::string grid(maxWidth * maxHeight, ' ');
+            for (std::size_t row = 0; row < frame.size(); row++)
+            {
+                grid.replace(row * maxWidth, frame[row].length(), frame[row]);
+            }
+            grids.push_back(grid);
+        }
+
+        // Build the same layout as a pack file so both sources share one code path
+        std::string runData;
+        std::vector<uint32_t> offsets(1, 0);
+        for (std::size_t i = 0; i < grids.size(); i++)
+        {
+            encodeRuns(grids[(i + grids.size() - 1) % grids.size()], grids[i], maxWidth, runData);
+            offsets.push_back(runData.length());
+        }
+
+        FramePackHeader header;
+        std::memcpy(header.magic, FRAME_PACK_MAGIC, 4);
+        header.version = FRAME_PACK_VERSION;
+        header.reserved = 0;
+        header.frameCount = frames.size();
+        header.width = maxWidth;
+        header.height = maxHeight;
+
+        std::string packed((const char*)&header, sizeof(header));
+        for (std::size_t i = 0; i < frames.size(); i++)
+        {
+            appendLittleEndian(packed, 0, 2);  // No per-frame delays in text frames
+        }
+        for (uint32_t offset : offsets)
+        {
+            appendLittleEndian(packed, offset, 4);
+        }
+        packed += grids[0];
+        packed += runData;
+
+        ownedData.assign(packed.begin(), packed.end());
+        data = ownedData.data();
+        dataSize = ownedData.size();
+        return parse();
+    }
+
+    int getFrameCount() const { return frameCount; }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    bool empty() const { return frameCount == 0; }
+
+    /**
+     * Gets the first frame without copying it
+     */
+    FrameView getKeyframe() const
+    {
+        FrameView view;
+        view.cells = keyframe;
+        view.width = width;
+        view.height = height;
+        return view;
+    }
+
+    /**
+     * Walks the runs that turn the previous frame into frame index
+     * (for index 0, the last frame into the keyframe)
+     * @param index Frame index, 0 to getFrameCount() - 1
+     * @param apply Callable invoked as apply(row, column, const char* cells, int length) for each run
+     */
+    template <typename Apply>
+    void forEachRun(int index, Apply apply) const
+    {
+        const char* run = runs + readLittleEndian(runOffsets + index * 4, 4);
+        const char* end = runs + readLittleEndian(runOffsets + (index + 1) * 4, 4);
+
+        while (run + 6 <= end)
+        {
+            int row = readLittleEndian(run, 2);
+            int col = readLittleEndian(run + 2, 2);
+            int length = readLittleEndian(run + 4, 2);
+            run += 6;
+
+            // Clip to the frame so a damaged pack cannot write outside it
+            length = std::min(length, (int)(end - run));
+            if (row < height && col < width)
+            {
+                apply(row, col, run, std::min(length, width - col));
+            }
+            run += length;
+        }
+    }
+
+    /**
+     * Reconstructs a whole frame by replaying the runs from the keyframe.
+     * Cost grows with the index; playback should apply one frame's runs at a time instead.
+     * @param index Frame index
+     * @param cells Receives width * height cells
+     */
+    void decodeFrame(int index, char* cells) const
+    {
+        std::memcpy(cells, keyframe, (std::size_t)width * height);
+        for (int i = 1; i <= index; i++)
+        {
+            forEachRun(i, [this, cells](int row, int col, const char* run, int length) {
+                std::memcpy(cells + row * width + col, run, length);
+            });
+        }
+    }
+
+    /**
+     * Gets how long a frame should stay on screen
+     * @param index Frame index
+     * @return Delay in milliseconds, 0 to follow the console speed
+     */
+    int getDelay(int index) const
+    {
+        const unsigned char* bytes = (const unsigned char*)delays + index * 2;
+        return bytes[0] | (bytes[1] << 8);
+    }
+
+private:
+    /**
+     * Validates the header and sets up pointers into data
+     * @return True if the data holds a complete frame pack
+     */
+    bool parse()
+    {
+        reset();
+
+        FramePackHeader header;
+        if (dataSize < sizeof(header))
+            return false;
+        std::memcpy(&header, data, sizeof(header));
+
+        if (std::memcmp(header.magic, FRAME_PACK_MAGIC, 4) != 0 || header.version != FRAME_PACK_VERSION)
+            return false;
+
+        if (header.frameCount == 0)
+            return false;
+
+        std::size_t offsetsStart = sizeof(header) + (std::size_t)header.frameCount * 2;
+        std::size_t keyframeStart = offsetsStart + ((std::size_t)header.frameCount + 1) * 4;
+        std::size_t runsStart = keyframeStart + (std::size_t)header.width * header.height;
+        if (dataSize < runsStart)
+            return false;
+
+        // Run offsets must be ordered and stay inside the file
+        std::size_t previous = 0;
+        for (uint32_t i = 0; i <= header.frameCount; i++)
+        {
+            std::size_t offset = readLittleEndian(data + offsetsStart + i * 4, 4);
+            if (offset < previous || runsStart + offset > dataSize)
+                return false;
+            previous = offset;
+        }
+
+        frameCount = header.frameCount;
+        width = header.width;
+        height = header.height;
+        delays = data + sizeof(header);
+        runOffsets = data + offsetsStart;
+        keyframe = data + keyframeStart;
+        runs = data + runsStart;
+        return true;
+    }
+
+    /**
+     * Appends the runs that turn one grid into another
+     * @param previous Cells of the frame before
+     * @param current Cells of the frame to encode
+     * @param rowWidth Cells per row
+     * @param out Receives the run records
+     */
+    static void encodeRuns(const std::string& previous, const std::string& current, int rowWidth, std::string& out)
+    {
+        for (std::size_t rowStart = 0; rowStart < current.length(); rowStart += rowWidth)
+        {
+            int col = 0;
+            while (col < rowWidth)
+            {
+                if (previous[rowStart + col] == current[rowStart + col])
+                {
+                    col++;
+                    continue;
+                }
+
+                // Extend the run while changes keep appearing within the merge gap
+                int start = col;
+                int end = col + 1;
+                int gap = 0;
+                for (col = end; col < rowWidth && gap < FRAME_RUN_MERGE_GAP; col++)
+                {
+                    if (previous[rowStart + col] != current[rowStart + col])
+                    {
+                        end = col + 1;
+                        gap = 0;
+                    }
+                    else
+                    {
+                        gap++;
+                    }
+                }
+
+                appendLittleEndian(out, rowStart / rowWidth, 2);
+                appendLittleEndian(out, start, 2);
+                appendLittleEndian(out, end - start, 2);
+                out.append(current, rowStart + start, end - start);
+                col = end;
+            }
+        }
+    }
+
+    static void appendLittleEndian(std::string& out, uint32_t value, int bytes)
+    {
+        for (int i = 0; i < bytes; i++)
+        {
+            out += (char)((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    static uint32_t readLittleEndian(const char* in, int bytes)
+    {
+        const unsigned char* u = (const unsigned char*)in;
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; i++)
+        {
+            value |= (uint32_t)u[i] << (8 * i);
+        }
+        return value;
+    }
+
+    void reset()
+    {
+        frameCount = 0;
+        width = 0;
+        height = 0;
+        delays = nullptr;
+        runOffsets = nullptr;
+        keyframe = nullptr;
+        runs = nullptr;
+    }
+
+    /**
+     * Releases the mapping or the in-memory copy
+     */
+    void unmap()
+    {
+        if (isMapped)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+#else
+            munmap((void*)data, dataSize);
+#endif
+        }
+#ifdef _WIN32
+        if (mappingHandle)
+        {
+            CloseHandle(mappingHandle);
+            mappingHandle = NULL;
+        }
+        if (fileHandle != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(fileHandle);
+            fileHandle = INVALID_HANDLE_VALUE;
+        }
+#endif
+
+        isMapped = false;
+        data = nullptr;
+        dataSize = 0;
+        ownedData.clear();
+        reset();
+    }
+};
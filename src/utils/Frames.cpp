@@ -1,95 +1,48 @@
 #include <iostream>
-#include <windows.h>
 #include <string>
-#include <fstream>
 #include <vector>
+#include <stdexcept>
+#include "FramePack.cpp"
 
-#define NUM_FRAMES 93
-#define NUM_ROWS 20
 #define FRAME_DIR "src/utils/data/ascii_frames/"
 
-class Frame
+class Frames
 {
 private:
-    std::string fileName;
-    int frameNumber;
-
-    std::vector<std::string> frameData;
+    FramePack pack;
 
-    void encodeFrame()
+public:
+    /**
+     * Loads the frame pack, or the loose frames in FRAME_DIR if there is no pack.
+     * The number of frames and rows comes from the data, not from the code.
+     * @param packPath Path of the .pack file
+     */
+    Frames(const std::string &packPath = FRAME_PACK_FILE)
     {
-        // open file
-        std::string fullDirectory = FRAME_DIR + fileName;
-        std::ifstream inFile(fullDirectory);
-        if (!inFile)
-        {
-            throw std::runtime_error("File not found: " + fullDirectory);
-        }
-
-        // Read frame data
-        std::string line;
-        int row = 0;
-        while (std::getline(inFile, line) && row < NUM_ROWS)
+        if (!pack.open(packPath) && !pack.loadDirectory(FRAME_DIR))
         {
-            this->frameData.push_back(line);
-            ++row;
+            throw std::runtime_error("No frames found in " + packPath + " or " + FRAME_DIR);
         }
-
-        inFile.close();
     }
 
-public:
-    Frame() {}
-
-    Frame(std::string fileName, int frameNumber)
+    int getNumFrames() const
     {
-        this->fileName = fileName;
-        this->frameNumber = frameNumber;
-
-        this->encodeFrame();
+        return pack.getFrameCount();
     }
 
-    std::vector<std::string> getFrameRows()
+    std::vector<std::string> getFrame(int index)
     {
-        return this->frameData;
-    }
-};
+        if (index < 0 || index >= pack.getFrameCount())
+            throw std::runtime_error("Frame index out of bounds: " + std::to_string(index));
 
-class Frames
-{
-private:
-    Frame frames[NUM_FRAMES];
-    int numFrames;
-    HANDLE hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
-    CONSOLE_SCREEN_BUFFER_INFO csbi;
-
-public:
-    Frames() {}
-
-    Frames(int numFrames = NUM_FRAMES)
-    {
-        this->numFrames = numFrames;
-        for (int i = 0; i < numFrames; i++)
-        {
-            char filenameC[100];
-            sprintf(filenameC, "frame_%02d.txt", i + 1);
-            std::string filename = filenameC;
-            frames[i] = Frame(filename, i + 1);
-        }
-    }
+        std::string cells(pack.getWidth() * pack.getHeight(), ' ');
+        pack.decodeFrame(index, &cells[0]);
 
-    std::vector<std::string> getFrame(int index)
-    {
-        try
+        std::vector<std::string> rows;
+        for (int row = 0; row < pack.getHeight(); row++)
         {
-            return frames[index].getFrameRows();
-        }
-        catch (const std::exception &e)
-        {
-            if (index < 0 || index >= numFrames)
-                throw std::runtime_error("Frame index out of bounds: " + std::to_string(index));
-
-            return {e.what()};
+            rows.push_back(cells.substr(row * pack.getWidth(), pack.getWidth()));
         }
+        return rows;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "RingBuffer.cpp"
+
+// Recent samples kept for the percentiles
+#define LATENCY_SAMPLES 1024
+
+/**
+ * LatencyStats - Percentiles over the most recent latency samples
+ *
+ * One thread records and any other may ask for a summary; a short lock
+ * guards the samples, since a summary is only asked for now and then.
+ */
+class LatencyStats
+{
+private:
+    mutable std::mutex lock;
+    RingBuffer<double> samples;  // Microseconds, newest last
+    long long count;
+    double maximum;
+
+public:
+    LatencyStats() : samples(LATENCY_SAMPLES)
+    {
+        count = 0;
+        maximum = 0;
+    }
+
+    /**
+     * Adds a sample
+     * @param microseconds Measured latency
+     */
+    void record(double microseconds)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        samples.push(microseconds);
+        count++;
+        maximum = std::max(maximum, microseconds);
+    }
+
+    /**
+     * Describes the recent samples, e.g. "p50 120us, p99 800us, max 2100us (35 samples)"
+     */
+    std::string summary() const
+    {
+        std::vector<double> sorted;
+        long long total;
+        double worst;
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            for (std::size_t i = 0; i < samples.size(); i++)
+            {
+                sorted.push_back(samples[i]);
+            }
+            total = count;
+            worst = maximum;
+        }
+
+        if (sorted.empty())
+            return "no samples";
+
+        std::sort(sorted.begin(), sorted.end());
+        return "p50 " + std::to_string((long long)percentile(sorted, 0.5)) + "us, p99 " +
+               std::to_string((long long)percentile(sorted, 0.99)) + "us, max " +
+               std::to_string((long long)worst) + "us (" + std::to_string(total) + " samples)";
+    }
+
+    /**
+     * Gets a percentile of samples sorted in ascending order, taking the nearest sample
+     * @param sorted Samples, smallest first
+     * @param fraction Percentile as a fraction, e.g. 0.99
+     * @return The sample, 0 if there are none
+     */
+    static double percentile(const std::vector<double>& sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0;
+        return sorted[(std::size_t)(fraction * (sorted.size() - 1) + 0.5)];
+    }
+};
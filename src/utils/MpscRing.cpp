@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * MpscRing - Bounded multi-producer single-consumer queue
+ *
+ * Any number of threads push and one thread pops, without locks. Each slot
+ * carries a sequence number telling whose turn it is: a producer claims a
+ * slot by advancing the shared enqueue position with a compare-exchange,
+ * fills it, then hands it to the consumer by bumping its sequence.
+ * Pushing into a full ring fails instead of waiting.
+ *
+ * Slot values are allocated once and swapped with the consumer's item on
+ * pop, so strings and vectors keep circulating their buffers instead of
+ * being reallocated for every item.
+ */
+template <typename T, size_t Capacity>
+class MpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "MpscRing capacity must be a power of two");
+
+private:
+    static const size_t MASK = Capacity - 1;
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    /**
+     * A slot is free for the producer at position p when sequence == p,
+     * and ready for the consumer when sequence == p + 1
+     */
+    typedef struct SlotStruct
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    } Slot;
+
+    Slot slots[Capacity];
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> enqueuePos;  // Shared by all producers
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> dequeuePos;  // Written by the consumer only
+
+public:
+    MpscRing()
+    {
+        for (size_t i = 0; i < Capacity; i++)
+        {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        enqueuePos.store(0, std::memory_order_relaxed);
+        dequeuePos.store(0, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    /**
+     * Copies an item into the ring (any thread)
+     * @param item Item to push
+     * @return False if the ring was full and the item was not pushed
+     */
+    bool tryPush(const T& item)
+    {
+        return tryPushWith([&item](T& slot) { slot = item; });
+    }
+
+    /**
+     * Claims a slot and lets the caller fill it in place (any thread),
+     * so the slot's existing buffers can be reused
+     * @param fill Called as fill(T& slot) once a slot is claimed
+     * @return False if the ring was full and fill was not called
+     */
+    template <typename Fill>
+    bool tryPushWith(Fill fill)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Slot* slot;
+
+        for (;;)
+        {
+            slot = &slots[pos & MASK];
+            size_t sequence = slot->sequence.load(std::memory_order_acquire);
+            intptr_t difference = (intptr_t)sequence - (intptr_t)pos;
+
+            if (difference == 0)
+            {
+                // Slot is free, claim it unless another producer got there first
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                // The consumer has not emptied this slot yet: the ring is full
+                return false;
+            }
+            else
+            {
+                // Another producer claimed it, try the next position
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        fill(slot->value);
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Takes the oldest item out of the ring (consumer only)
+     * @param item Receives the item; its old contents are left in the slot for reuse
+     * @return False if the ring is empty or the oldest item is still being written
+     */
+    bool tryPop(T& item)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Slot& slot = slots[pos & MASK];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+        if ((intptr_t)sequence - (intptr_t)(pos + 1) < 0)
+            return false;
+
+        std::swap(item, slot.value);
+        slot.sequence.store(pos + Capacity, std::memory_order_release);
+        dequeuePos.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Number of claimed slots not yet popped; only a snapshot while producers are running
+     */
+    size_t size() const
+    {
+        size_t head = dequeuePos.load(std::memory_order_acquire);
+        size_t tail = enqueuePos.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : 0;
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "Terminal.cpp"
+#include <string>
+#include <vector>
+
+/**
+ * OffscreenTerminal - Terminal backend that renders into an in-memory cell grid
+ *
+ * Used for headless runs: nothing reaches a real console, there is never any
+ * input, and waits return immediately so the caller can drive its own clock.
+ */
+class OffscreenTerminal : public Terminal
+{
+private:
+    int width;
+    int height;
+    std::vector<char> cells;
+    int cursorX;
+    int cursorY;
+
+    // Output statistics, the equivalent of what a real terminal would receive
+    long long bytesWritten;
+    long long flushCount;
+    long long pendingBytes;
+
+public:
+    OffscreenTerminal(int width = 120, int height = 30)
+    {
+        this->width = width;
+        this->height = height;
+        cells.assign(width * height, ' ');
+        cursorX = 0;
+        cursorY = 0;
+        bytesWritten = 0;
+        flushCount = 0;
+        pendingBytes = 0;
+    }
+
+    void getSize(int& width, int& height) override
+    {
+        width = this->width;
+        height = this->height;
+    }
+
+    void moveCursor(int x, int y) override
+    {
+        cursorX = x;
+        cursorY = y;
+        pendingBytes += 8;  // Roughly the size of a VT cursor position sequence
+    }
+
+    void write(const char* text, int length) override
+    {
+        for (int i = 0; i < length; i++)
+        {
+            if (cursorY >= 0 && cursorY < height && cursorX >= 0 && cursorX < width)
+            {
+                cells[cursorY * width + cursorX] = text[i];
+            }
+            cursorX++;
+        }
+        pendingBytes += length;
+    }
+
+    void clearScreen() override
+    {
+        std::fill(cells.begin(), cells.end(), ' ');
+        cursorX = 0;
+        cursorY = 0;
+    }
+
+    void setCursorVisible(bool) override
+    {
+        pendingBytes += 6;  // Size of a VT show/hide cursor sequence
+    }
+
+    void flush() override
+    {
+        bytesWritten += pendingBytes;
+        pendingBytes = 0;
+        flushCount++;
+    }
+
+    bool readKey(KeyEvent&) override
+    {
+        return false;
+    }
+
+    KeyEvent waitKey() override
+    {
+        // Nobody is there to press a key; behave as if Enter was pressed
+        KeyEvent key;
+        key.code = 13;
+        key.special = false;
+        return key;
+    }
+
+    bool waitForInput(Deadline) override
+    {
+        return false;
+    }
+
+    bool isInputClosed() const override
+    {
+        return false;
+    }
+
+    void cancelWait() override
+    {
+    }
+
+    void resetWait() override
+    {
+    }
+
+    /**
+     * Gets the current screen contents
+     * @return One line per row, each followed by a newline
+     */
+    std::string snapshot() const
+    {
+        std::string text;
+        text.reserve((width + 1) * height);
+        for (int row = 0; row < height; row++)
+        {
+            text.append(&cells[row * width], width);
+            text += '\n';
+        }
+        return text;
+    }
+
+    long long getBytesWritten() const { return bytesWritten; }
+    long long getFlushCount() const { return flushCount; }
+};
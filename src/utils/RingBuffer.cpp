@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * RingBuffer - Keeps the newest items up to a fixed capacity
+ *
+ * Appending is O(1): once the buffer is full, each new item overwrites the
+ * oldest one in place, so items that own buffers (strings, vectors) reuse
+ * their memory. Storage grows with the first items instead of being
+ * allocated up front, so a large capacity costs nothing until it is used.
+ * Items are indexed from the oldest one kept (0) to the newest (size() - 1).
+ */
+template <typename T>
+class RingBuffer
+{
+private:
+    std::vector<T> items;
+    std::size_t maxItems;
+    std::size_t oldest;  // Slot of item 0 once the buffer has wrapped
+
+public:
+    /**
+     * Constructor for RingBuffer
+     * @param capacity Most items kept; older ones are overwritten (at least 1)
+     */
+    RingBuffer(std::size_t capacity)
+    {
+        maxItems = capacity > 0 ? capacity : 1;
+        oldest = 0;
+    }
+
+    /**
+     * Appends an item, dropping the oldest one if the buffer is full
+     * @param item Item to copy in
+     */
+    void push(const T& item)
+    {
+        if (items.size() < maxItems)
+        {
+            items.push_back(item);
+            return;
+        }
+
+        items[oldest] = item;
+        oldest = (oldest + 1) % maxItems;
+    }
+
+    /**
+     * Removes every item; the storage is kept for reuse
+     */
+    void clear()
+    {
+        items.clear();
+        oldest = 0;
+    }
+
+    /**
+     * Gets an item, 0 being the oldest kept
+     */
+    const T& operator[](std::size_t index) const
+    {
+        return items[(oldest + index) % items.size()];
+    }
+
+    /**
+     * Gets the newest item; the buffer must not be empty
+     */
+    const T& back() const
+    {
+        return (*this)[items.size() - 1];
+    }
+
+    std::size_t size() const
+    {
+        return items.size();
+    }
+
+    bool empty() const
+    {
+        return items.empty();
+    }
+
+    std::size_t capacity() const
+    {
+        return maxItems;
+    }
+};
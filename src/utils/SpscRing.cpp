@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+/**
+ * SpscRing - Bounded single-producer single-consumer queue
+ *
+ * Exactly one thread pushes and exactly one thread pops. Neither side takes a
+ * lock or waits: push fails when the ring is full and pop fails when it is
+ * empty, and the caller decides what to do about it. Slots are allocated once
+ * up front and reused, so items that own buffers keep their capacity.
+ */
+template <typename T, size_t Capacity>
+class SpscRing
+{
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "SpscRing capacity must be a power of two");
+
+private:
+    // Indices only ever grow; a slot is index % Capacity
+    static const size_t MASK = Capacity - 1;
+
+    // Each side's index sits on its own cache line next to its cached copy of the
+    // other side's index, so the threads only share a line when the ring looks full or empty
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> tail;  // Next slot to push, written by the producer
+    size_t cachedHead;                                  // Producer's last look at head
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> head;  // Next slot to pop, written by the consumer
+    size_t cachedTail;                                  // Consumer's last look at tail
+
+    alignas(CACHE_LINE_SIZE) T slots[Capacity];
+
+public:
+    SpscRing()
+    {
+        tail.store(0, std::memory_order_relaxed);
+        head.store(0, std::memory_order_relaxed);
+        cachedHead = 0;
+        cachedTail = 0;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * Moves an item into the ring (producer only)
+     * @param item Item to push, left untouched if the ring is full
+     * @return True if the item was pushed
+     */
+    bool tryPush(T& item)
+    {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+
+        if (currentTail - cachedHead == Capacity)
+        {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (currentTail - cachedHead == Capacity)
+                return false;
+        }
+
+        slots[currentTail & MASK] = std::move(item);
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Moves the oldest item out of the ring (consumer only)
+     * @param item Receives the item
+     * @return True if an item was popped
+     */
+    bool tryPop(T& item)
+    {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+
+        if (currentHead == cachedTail)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (currentHead == cachedTail)
+                return false;
+        }
+
+        item = std::move(slots[currentHead & MASK]);
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Number of items waiting; only a snapshot while the other side is running
+     */
+    size_t size() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const
+    {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity()
+    {
+        return Capacity;
+    }
+};
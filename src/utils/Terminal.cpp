@@ -0,0 +1,726 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <chrono>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <conio.h>
+#else
+#include <termios.h>
+#include <unistd.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <cerrno>
+#include <cstdlib>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+#endif
+
+typedef std::chrono::steady_clock::time_point Deadline;
+
+// Deadline value meaning "wait until input arrives, however long that takes"
+#define NO_DEADLINE (Deadline::max())
+
+// Key codes for special keys, matching the scan codes _getch() reports after a 0/224 prefix
+#define KEY_UP 72
+#define KEY_DOWN 80
+#define KEY_LEFT 75
+#define KEY_RIGHT 77
+#define KEY_HOME 71
+#define KEY_END 79
+#define KEY_PAGE_UP 73
+#define KEY_PAGE_DOWN 81
+#define KEY_DELETE 83
+
+// How long an ESC with no rest of its sequence yet waits for the rest before it counts as the Escape key
+#define ESCAPE_TIMEOUT_MS 50
+
+/**
+ * A single keypress as seen by KeyboardHandler
+ */
+typedef struct KeyEventStruct
+{
+    int code;        // Character code, or one of the KEY_* codes when special is set
+    bool special;    // True for arrow/navigation keys
+    Deadline readAt; // When the input stage read it, for echo latency
+} KeyEvent;
+
+/**
+ * Terminal - Abstract console backend used by DisplayHandler and KeyboardHandler
+ *
+ * Output calls are buffered and only reach the screen on flush(), so a whole
+ * frame can go out in a single write.
+ */
+class Terminal
+{
+public:
+    virtual ~Terminal() {}
+
+    /**
+     * Gets the visible size of the terminal window
+     * @param width Receives the number of columns
+     * @param height Receives the number of rows
+     */
+    virtual void getSize(int& width, int& height) = 0;
+
+    /**
+     * Moves the cursor to a zero-based column and row
+     */
+    virtual void moveCursor(int x, int y) = 0;
+
+    /**
+     * Writes text at the cursor position
+     */
+    virtual void write(const char* text, int length) = 0;
+
+    void write(const std::string& text)
+    {
+        write(text.data(), (int)text.length());
+    }
+
+    /**
+     * Blanks the whole screen and homes the cursor
+     */
+    virtual void clearScreen() = 0;
+
+    /**
+     * Shows or hides the cursor
+     */
+    virtual void setCursorVisible(bool visible) = 0;
+
+    /**
+     * Sends everything buffered so far to the screen
+     */
+    virtual void flush() = 0;
+
+    /**
+     * Reads one key without blocking
+     * @param key Receives the key
+     * @return True if a key was available
+     */
+    virtual bool readKey(KeyEvent& key) = 0;
+
+    /**
+     * Blocks until a key is pressed
+     * @return The key that was pressed
+     */
+    virtual KeyEvent waitKey() = 0;
+
+    /**
+     * Sleeps until input is readable or the deadline passes, whichever comes first
+     * @param deadline Time to give up waiting, or NO_DEADLINE
+     * @return True if input is ready to be read
+     */
+    virtual bool waitForInput(Deadline deadline) = 0;
+
+    /**
+     * Checks whether input has ended for good, e.g. stdin was /dev/null or its pipe was closed
+     * @return True once no more keys can ever arrive
+     */
+    virtual bool isInputClosed() const = 0;
+
+    /**
+     * Wakes a waitForInput() sleeping on another thread and makes every later one return at once.
+     * Used at shutdown, so the input stage can wait without a deadline.
+     */
+    virtual void cancelWait() = 0;
+
+    /**
+     * Undoes cancelWait(), so waits block again, e.g. for the exit screen's keypress.
+     * Call once the thread whose wait was cancelled has stopped.
+     */
+    virtual void resetWait() = 0;
+
+protected:
+    /**
+     * Milliseconds left until a deadline, rounded up so a timed wait never returns early
+     * @return Remaining time, 0 if the deadline has passed, -1 for NO_DEADLINE
+     */
+    static long long millisecondsUntil(Deadline deadline)
+    {
+        if (deadline == NO_DEADLINE)
+            return -1;
+
+        auto remaining = deadline - std::chrono::steady_clock::now();
+        if (remaining <= std::chrono::steady_clock::duration::zero())
+            return 0;
+
+        return std::chrono::ceil<std::chrono::milliseconds>(remaining).count();
+    }
+};
+
+#ifdef _WIN32
+
+/**
+ * Win32Terminal - Console API backend (SetConsoleCursorPosition, _kbhit/_getch)
+ */
+class Win32Terminal : public Terminal
+{
+private:
+    HANDLE hConsole;
+    HANDLE cancelEvent;  // Manual-reset, so it stays signalled from cancelWait() until resetWait()
+    CONSOLE_SCREEN_BUFFER_INFO csbi;
+    std::string pending;  // Text written since the last cursor move
+
+public:
+    Win32Terminal()
+    {
+        hConsole = GetStdHandle(STD_OUTPUT_HANDLE);
+        cancelEvent = CreateEventA(NULL, TRUE, FALSE, NULL);
+    }
+
+    ~Win32Terminal()
+    {
+        if (cancelEvent)
+        {
+            CloseHandle(cancelEvent);
+        }
+    }
+
+    void getSize(int& width, int& height) override
+    {
+        GetConsoleScreenBufferInfo(hConsole, &csbi);
+        width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+        height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+    }
+
+    void moveCursor(int x, int y) override
+    {
+        // Cursor moves are API calls, so text queued before them must go out first
+        flush();
+
+        COORD coord;
+        coord.X = x;
+        coord.Y = y;
+        SetConsoleCursorPosition(hConsole, coord);
+    }
+
+    void write(const char* text, int length) override
+    {
+        pending.append(text, length);
+    }
+
+    void clearScreen() override
+    {
+        // Use Windows API for faster clearing
+        COORD coordScreen = {0, 0};
+        DWORD cCharsWritten;
+        DWORD dwConSize;
+
+        pending.clear();
+        GetConsoleScreenBufferInfo(hConsole, &csbi);
+        dwConSize = csbi.dwSize.X * csbi.dwSize.Y;
+
+        FillConsoleOutputCharacter(hConsole, (TCHAR)' ', dwConSize, coordScreen, &cCharsWritten);
+        FillConsoleOutputAttribute(hConsole, csbi.wAttributes, dwConSize, coordScreen, &cCharsWritten);
+        SetConsoleCursorPosition(hConsole, coordScreen);
+    }
+
+    void setCursorVisible(bool visible) override
+    {
+        flush();
+
+        CONSOLE_CURSOR_INFO cursorInfo;
+        GetConsoleCursorInfo(hConsole, &cursorInfo);
+        cursorInfo.bVisible = visible;
+        SetConsoleCursorInfo(hConsole, &cursorInfo);
+    }
+
+    void flush() override
+    {
+        if (pending.empty())
+            return;
+
+        DWORD written;
+        WriteConsoleA(hConsole, pending.data(), (DWORD)pending.length(), &written, NULL);
+        pending.clear();
+    }
+
+    bool readKey(KeyEvent& key) override
+    {
+        if (!_kbhit())
+            return false;
+
+        key = waitKey();
+        return true;
+    }
+
+    bool waitForInput(Deadline deadline) override
+    {
+        if (_kbhit())
+            return true;
+
+        // The input handle is signalled for mouse and focus events too; _kbhit() sorts those out
+        HANDLE handles[2] = {GetStdHandle(STD_INPUT_HANDLE), cancelEvent};
+        long long timeout = millisecondsUntil(deadline);
+        DWORD signalled = WaitForMultipleObjects(cancelEvent ? 2 : 1, handles, FALSE, timeout < 0 ? INFINITE : (DWORD)timeout);
+        if (signalled == WAIT_OBJECT_0 + 1)
+            return false;
+        return _kbhit() != 0;
+    }
+
+    bool isInputClosed() const override
+    {
+        return false;
+    }
+
+    void cancelWait() override
+    {
+        if (cancelEvent)
+        {
+            SetEvent(cancelEvent);
+        }
+    }
+
+    void resetWait() override
+    {
+        if (cancelEvent)
+        {
+            ResetEvent(cancelEvent);
+        }
+    }
+
+    KeyEvent waitKey() override
+    {
+        KeyEvent key;
+        int code = _getch();
+
+        // Handle special keys that return two values
+        if (code == 0 || code == 224)
+        {
+            key.code = _getch();
+            key.special = true;
+        }
+        else
+        {
+            key.code = code;
+            key.special = false;
+        }
+
+        return key;
+    }
+};
+
+#else
+
+/**
+ * PosixTerminal - termios raw mode input and VT escape sequence output
+ */
+class PosixTerminal : public Terminal
+{
+private:
+    struct termios originalMode;
+    bool rawModeEnabled;
+    std::string outputBuffer;  // Whole frame, sent with one write() on flush
+    std::string inputBuffer;   // Bytes read from stdin that are not yet decoded
+    bool inputClosed;          // stdin reached end of file; it is not polled any more
+    Deadline lastInputAt;      // When bytes were last added to inputBuffer
+    int timerFd;               // timerfd armed with the wait deadline, -1 when unavailable
+    int cancelPipe[2];         // Self-pipe; cancelWait() writes to it and resetWait() drains it
+
+public:
+    PosixTerminal()
+    {
+        rawModeEnabled = false;
+        inputClosed = false;
+        lastInputAt = std::chrono::steady_clock::now();
+
+#ifdef __linux__
+        // An absolute CLOCK_MONOTONIC timer wakes poll() exactly at the deadline, not at the next whole millisecond
+        timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#else
+        timerFd = -1;
+#endif
+
+        if (pipe(cancelPipe) != 0)
+        {
+            cancelPipe[0] = cancelPipe[1] = -1;
+        }
+        else
+        {
+            // Draining must stop once the pipe is empty instead of waiting for more
+            fcntl(cancelPipe[0], F_SETFL, fcntl(cancelPipe[0], F_GETFL) | O_NONBLOCK);
+        }
+
+        if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &originalMode) == 0)
+        {
+            // Byte-at-a-time input without echo; Ctrl+C/Ctrl+Z arrive as keys like they do with _getch()
+            struct termios raw = originalMode;
+            raw.c_iflag &= ~(IXON | ICRNL | BRKINT | INPCK | ISTRIP);
+            raw.c_lflag &= ~(ECHO | ICANON | ISIG | IEXTEN);
+            raw.c_cc[VMIN] = 0;
+            raw.c_cc[VTIME] = 0;
+
+            rawModeEnabled = tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0;
+        }
+
+        // Alternate screen with line wrap off, so writing the last column never scrolls
+        outputBuffer += "\x1b[?1049h\x1b[?7l";
+        flush();
+    }
+
+    ~PosixTerminal()
+    {
+        outputBuffer += "\x1b[?7h\x1b[?25h\x1b[?1049l";
+        flush();
+
+        if (rawModeEnabled)
+        {
+            tcsetattr(STDIN_FILENO, TCSAFLUSH, &originalMode);
+        }
+
+        if (timerFd >= 0)
+        {
+            close(timerFd);
+        }
+        if (cancelPipe[0] >= 0)
+        {
+            close(cancelPipe[0]);
+            close(cancelPipe[1]);
+        }
+    }
+
+    void getSize(int& width, int& height) override
+    {
+        struct winsize ws;
+        if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0 && ws.ws_row > 0)
+        {
+            width = ws.ws_col;
+            height = ws.ws_row;
+            return;
+        }
+
+        // Not a terminal, fall back to the environment or the classic 80x24
+        const char* columns = std::getenv("COLUMNS");
+        const char* lines = std::getenv("LINES");
+        width = columns ? std::atoi(columns) : 80;
+        height = lines ? std::atoi(lines) : 24;
+        if (width <= 0) width = 80;
+        if (height <= 0) height = 24;
+    }
+
+    void moveCursor(int x, int y) override
+    {
+        char sequence[32];
+        int length = std::snprintf(sequence, sizeof(sequence), "\x1b[%d;%dH", y + 1, x + 1);
+        outputBuffer.append(sequence, length);
+    }
+
+    void write(const char* text, int length) override
+    {
+        outputBuffer.append(text, length);
+    }
+
+    void clearScreen() override
+    {
+        outputBuffer += "\x1b[2J\x1b[H";
+    }
+
+    void setCursorVisible(bool visible) override
+    {
+        outputBuffer += visible ? "\x1b[?25h" : "\x1b[?25l";
+    }
+
+    void flush() override
+    {
+        const char* data = outputBuffer.data();
+        size_t remaining = outputBuffer.length();
+
+        while (remaining > 0)
+        {
+            ssize_t written = ::write(STDOUT_FILENO, data, remaining);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+
+        outputBuffer.clear();
+    }
+
+    bool readKey(KeyEvent& key) override
+    {
+        fillInputBuffer();
+        return decodeKey(key);
+    }
+
+    KeyEvent waitKey() override
+    {
+        KeyEvent key;
+        while (!readKey(key))
+        {
+            if (inputClosed)
+            {
+                // Nobody can press a key any more; behave as if Enter was pressed
+                key.code = 13;
+                key.special = false;
+                return key;
+            }
+            waitForInput(NO_DEADLINE);
+        }
+        return key;
+    }
+
+    bool waitForInput(Deadline deadline) override
+    {
+        // Bytes left over from a partially decoded batch count as input, except the start
+        // of an escape sequence whose rest is still on its way; wait for that no longer than its timeout
+        if (!inputBuffer.empty())
+        {
+            if (!isHoldingEscape())
+                return true;
+
+            Deadline escapeDeadline = lastInputAt + std::chrono::milliseconds(ESCAPE_TIMEOUT_MS);
+            if (escapeDeadline < deadline)
+                deadline = escapeDeadline;
+        }
+
+        // poll() skips a negative descriptor, so a missing pipe or timer, or stdin once it has ended, is left out
+        struct pollfd pfds[3] = {{inputClosed ? -1 : STDIN_FILENO, POLLIN, 0}, {cancelPipe[0], POLLIN, 0}, {timerFd, POLLIN, 0}};
+        int count = 2;
+        long long timeout = millisecondsUntil(deadline);
+
+        if (timeout == 0)
+        {
+            // Already due, just check for input without sleeping
+        }
+        else if (timeout > 0 && armTimer(deadline))
+        {
+            count = 3;
+            timeout = -1;
+        }
+
+        int ready;
+        do
+        {
+            ready = poll(pfds, count, (int)timeout);
+        } while (ready < 0 && errno == EINTR);
+
+        if (count == 3)
+        {
+            disarmTimer();
+        }
+
+        if (pfds[1].revents & POLLIN)
+            return false;
+        if (ready > 0 && (pfds[0].revents & (POLLIN | POLLHUP)))
+            return true;
+        return !inputBuffer.empty() && !isHoldingEscape();
+    }
+
+    bool isInputClosed() const override
+    {
+        return inputClosed;
+    }
+
+    void cancelWait() override
+    {
+        if (cancelPipe[1] >= 0)
+        {
+            char byte = 0;
+            while (::write(cancelPipe[1], &byte, 1) < 0 && errno == EINTR)
+            {
+            }
+        }
+    }
+
+    void resetWait() override
+    {
+        char bytes[16];
+        while (cancelPipe[0] >= 0 && ::read(cancelPipe[0], bytes, sizeof(bytes)) > 0)
+        {
+        }
+    }
+
+private:
+    /**
+     * Arms the timerfd to fire at an absolute steady_clock deadline
+     * @return True if the timer is armed, false to fall back to a poll() timeout
+     */
+    bool armTimer(Deadline deadline)
+    {
+#ifdef __linux__
+        if (timerFd < 0)
+            return false;
+
+        // steady_clock is CLOCK_MONOTONIC on Linux, so its epoch matches the timer's
+        auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = sinceEpoch / 1000000000LL;
+        spec.it_value.tv_nsec = sinceEpoch % 1000000000LL;
+
+        return timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, NULL) == 0;
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Stops the timerfd and drains any expiration it recorded
+     */
+    void disarmTimer()
+    {
+#ifdef __linux__
+        struct itimerspec spec = {};
+        timerfd_settime(timerFd, 0, &spec, NULL);
+
+        unsigned long long expirations;
+        while (::read(timerFd, &expirations, sizeof(expirations)) > 0)
+        {
+        }
+#endif
+    }
+
+    /**
+     * Moves whatever stdin has ready into the input buffer without blocking; notes when stdin has ended
+     */
+    void fillInputBuffer()
+    {
+        char bytes[256];
+        struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+
+        while (!inputClosed && poll(&pfd, 1, 0) > 0 && (pfd.revents & (POLLIN | POLLHUP)))
+        {
+            ssize_t count = ::read(STDIN_FILENO, bytes, sizeof(bytes));
+            if (count < 0 && errno == EINTR)
+                continue;
+            if (count < 0)
+                break;
+            if (count == 0)
+            {
+                inputClosed = true;
+                break;
+            }
+            inputBuffer.append(bytes, count);
+            lastInputAt = std::chrono::steady_clock::now();
+        }
+    }
+
+    /**
+     * Checks whether the input buffer starts with an ESC sequence that is not complete yet
+     * and may still be finished by the next read
+     * @return True if decoding should wait for more bytes
+     */
+    bool isHoldingEscape() const
+    {
+        if (inputClosed || inputBuffer.empty() || inputBuffer[0] != 27)
+            return false;
+        if (std::chrono::steady_clock::now() >= lastInputAt + std::chrono::milliseconds(ESCAPE_TIMEOUT_MS))
+            return false;
+        if (inputBuffer.length() == 1)
+            return true;
+        if (inputBuffer[1] != '[' && inputBuffer[1] != 'O')
+            return false;
+
+        // CSI/SS3 without its final byte yet
+        for (size_t i = 2; i < inputBuffer.length(); i++)
+        {
+            if (inputBuffer[i] >= 0x40 && inputBuffer[i] <= 0x7E)
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * Decodes one key from the front of the input buffer, translating
+     * VT sequences and control bytes to the codes _getch() would give
+     * @param key Receives the key
+     * @return True if a key was decoded
+     */
+    bool decodeKey(KeyEvent& key)
+    {
+        // The rest of a sequence split across reads is kept for the next read
+        if (inputBuffer.empty() || isHoldingEscape())
+            return false;
+
+        unsigned char first = inputBuffer[0];
+        key.special = false;
+
+        if (first == 27 && inputBuffer.length() >= 3 && (inputBuffer[1] == '[' || inputBuffer[1] == 'O'))
+        {
+            // CSI/SS3 sequence: parameters then a final byte in the @..~ range
+            size_t end = 2;
+            while (end < inputBuffer.length() && (inputBuffer[end] < 0x40 || inputBuffer[end] > 0x7E))
+                end++;
+
+            if (end < inputBuffer.length())
+            {
+                std::string sequence = inputBuffer.substr(2, end - 2 + 1);
+                inputBuffer.erase(0, end + 1);
+
+                key.special = true;
+                key.code = translateSequence(sequence);
+                return true;
+            }
+        }
+
+        inputBuffer.erase(0, 1);
+
+        switch (first)
+        {
+        case 127: // Most terminals send DEL for Backspace
+            key.code = 8;
+            break;
+        case '\n':
+            key.code = 13;
+            break;
+        default:
+            key.code = first;
+            break;
+        }
+
+        return true;
+    }
+
+    /**
+     * Maps the body of a CSI/SS3 sequence to a special key code
+     * @param sequence Parameter bytes followed by the final byte
+     * @return KEY_* code, or 0 if the sequence is not recognised
+     */
+    int translateSequence(const std::string& sequence)
+    {
+        switch (sequence.back())
+        {
+        case 'A': return KEY_UP;
+        case 'B': return KEY_DOWN;
+        case 'C': return KEY_RIGHT;
+        case 'D': return KEY_LEFT;
+        case 'H': return KEY_HOME;
+        case 'F': return KEY_END;
+        case '~':
+            switch (std::atoi(sequence.c_str()))
+            {
+            case 1: case 7: return KEY_HOME;
+            case 4: case 8: return KEY_END;
+            case 3: return KEY_DELETE;
+            case 5: return KEY_PAGE_UP;
+            case 6: return KEY_PAGE_DOWN;
+            }
+            break;
+        }
+        return 0;
+    }
+};
+
+#endif
+
+/**
+ * Creates the terminal backend for the current platform
+ * @return New terminal, owned by the caller
+ */
+Terminal* createTerminal()
+{
+#ifdef _WIN32
+    return new Win32Terminal();
+#else
+    return new PosixTerminal();
+#endif
+}
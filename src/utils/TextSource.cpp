@@ -0,0 +1,146 @@
+#pragma once
+
+#include <cerrno>
+#include <string>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// TextSource::read() result at the end of a regular file
+#define TEXT_SOURCE_END -1
+
+/**
+ * TextSource - A file or named pipe read a piece at a time without ever waiting
+ *
+ * Regular files report their end, so the reader can start them over; pipes
+ * only ever run dry for a while, including when no writer has them open,
+ * and carry on as soon as someone writes again.
+ */
+class TextSource
+{
+private:
+    int fd;
+    bool isPipe;
+    std::string path;
+
+public:
+    TextSource()
+    {
+        fd = -1;
+        isPipe = false;
+    }
+
+    TextSource(const TextSource&) = delete;
+    TextSource& operator=(const TextSource&) = delete;
+
+    ~TextSource()
+    {
+        close();
+    }
+
+    /**
+     * Opens a file or named pipe for reading in place of the current one; a pipe without a writer yet is fine
+     * @param path File to read
+     * @return False if it could not be opened, leaving the current one open; errno tells why
+     */
+    bool open(const std::string& path)
+    {
+#ifdef _WIN32
+        int opened = ::_open(path.c_str(), _O_RDONLY | _O_BINARY);
+        bool pipe = false;
+#else
+        // Non-blocking, or opening a pipe would wait for a writer
+        int opened = ::open(path.c_str(), O_RDONLY | O_NONBLOCK);
+        struct stat info;
+        bool statFailed = opened >= 0 && ::fstat(opened, &info) != 0;
+        if (opened >= 0 && (statFailed || S_ISDIR(info.st_mode)))
+        {
+            int error = statFailed ? errno : EISDIR;
+            ::close(opened);
+            opened = -1;
+            errno = error;
+        }
+        bool pipe = opened >= 0 && !S_ISREG(info.st_mode);
+#endif
+        if (opened < 0)
+            return false;
+
+        close();
+        fd = opened;
+        isPipe = pipe;
+        this->path = path;
+        return true;
+    }
+
+    void close()
+    {
+        if (fd >= 0)
+        {
+#ifdef _WIN32
+            ::_close(fd);
+#else
+            ::close(fd);
+#endif
+        }
+        fd = -1;
+        path.clear();
+    }
+
+    bool isOpen() const
+    {
+        return fd >= 0;
+    }
+
+    /**
+     * Gets the path given to open(), empty when nothing is open
+     */
+    const std::string& getPath() const
+    {
+        return path;
+    }
+
+    /**
+     * Reads whatever is available right now
+     * @param buffer Receives the bytes
+     * @param size Most bytes to read
+     * @return Bytes read; 0 if nothing is available yet, TEXT_SOURCE_END at the end of a regular file
+     */
+    int read(char* buffer, int size)
+    {
+        if (fd < 0)
+            return 0;
+
+#ifdef _WIN32
+        int count = ::_read(fd, buffer, size);
+#else
+        int count = (int)::read(fd, buffer, size);
+#endif
+        if (count > 0)
+            return count;
+
+        // A pipe is empty or has no writer for now; an error is treated the same way
+        if (count < 0 || isPipe)
+            return 0;
+        return TEXT_SOURCE_END;
+    }
+
+    /**
+     * Goes back to the start of a regular file
+     */
+    void rewind()
+    {
+        if (fd < 0 || isPipe)
+            return;
+#ifdef _WIN32
+        ::_lseek(fd, 0, SEEK_SET);
+#else
+        ::lseek(fd, 0, SEEK_SET);
+#endif
+    }
+};
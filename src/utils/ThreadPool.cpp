@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Cells a drawing task should cover at least, so the work outweighs handing it to another thread
+#define RENDER_TILE_CELLS 16384
+
+/**
+ * One call of ThreadPool::run(): the task to run and how many of its parts are left
+ */
+typedef struct PoolJobStruct
+{
+    const std::function<void(int)>* task;
+    std::atomic<int> remaining;
+} PoolJob;
+
+/**
+ * One part of a job waiting in a worker's queue
+ */
+typedef struct PoolTaskStruct
+{
+    PoolJob* job;
+    int index;
+} PoolTask;
+
+/**
+ * A worker's own queue; the worker takes from the back, others steal from the front
+ */
+typedef struct PoolQueueStruct
+{
+    std::mutex lock;
+    std::deque<PoolTask> tasks;
+} PoolQueue;
+
+/**
+ * ThreadPool - Small work-stealing pool for drawing the parts of one frame at once
+ *
+ * run() splits a job into numbered parts and deals them out over the
+ * workers' queues. A worker takes parts from the back of its own queue and,
+ * once that is empty, steals from the front of the others, so a worker that
+ * drew cheap parts picks up what is left of a busy one's. The calling thread
+ * helps until every part is done, which makes run() the join: when it
+ * returns, everything the parts drew is in place.
+ *
+ * Several threads may call run() at the same time; each waits only for its own job.
+ * Parts must not throw or wait on each other.
+ */
+class ThreadPool
+{
+private:
+    std::vector<PoolQueue*> queues;  // One per worker
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue;  // Where the next job starts dealing, to spread jobs out
+
+    // Idle workers sleep until parts are queued
+    std::atomic<int> queuedTasks;
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping;
+
+public:
+    /**
+     * Constructor for ThreadPool
+     * @param threads Worker threads besides the caller; -1 for one less than the number of cores.
+     *                With none, run() simply runs every part on the calling thread.
+     */
+    ThreadPool(int threads = -1)
+    {
+        if (threads < 0)
+        {
+            threads = std::max(0, (int)std::thread::hardware_concurrency() - 1);
+        }
+
+        nextQueue = 0;
+        queuedTasks = 0;
+        stopping = false;
+
+        for (int i = 0; i < threads; i++)
+        {
+            queues.push_back(new PoolQueue());
+        }
+        for (int i = 0; i < threads; i++)
+        {
+            workers.emplace_back(&ThreadPool::runWorker, this, i);
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wake.notify_all();
+
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+        for (PoolQueue* queue : queues)
+        {
+            delete queue;
+        }
+    }
+
+    /**
+     * Gets the number of worker threads, not counting callers of run()
+     */
+    int getThreadCount() const
+    {
+        return (int)workers.size();
+    }
+
+    /**
+     * Runs task(0) to task(count - 1) across the pool and returns once all of them are done
+     * @param count Number of parts
+     * @param task Draws one part; parts run in any order, on any thread, and must touch disjoint data
+     */
+    void run(int count, const std::function<void(int)>& task)
+    {
+        if (count <= 0)
+            return;
+
+        if (workers.empty() || count == 1)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        PoolJob job;
+        job.task = &task;
+        job.remaining.store(count, std::memory_order_relaxed);
+
+        // Deal the parts round-robin; whoever is free first will steal the rest anyway
+        unsigned first = nextQueue.fetch_add(1, std::memory_order_relaxed);
+        for (int i = 0; i < count; i++)
+        {
+            PoolQueue* queue = queues[(first + i) % queues.size()];
+            std::lock_guard<std::mutex> guard(queue->lock);
+            queue->tasks.push_back(PoolTask{&job, i});
+        }
+        queuedTasks.fetch_add(count, std::memory_order_release);
+
+        // Taking the lock orders the count above before any worker's check of it
+        {
+            std::lock_guard<std::mutex> guard(sleepLock);
+        }
+        wake.notify_all();
+
+        // Help out until every part of this job has finished
+        PoolTask next;
+        while (job.remaining.load(std::memory_order_acquire) > 0)
+        {
+            if (steal(-1, next))
+            {
+                runTask(next);
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    /**
+     * Worker loop: own queue first, then steal, then sleep until more parts are queued
+     * @param self Index of the worker's queue
+     */
+    void runWorker(int self)
+    {
+        PoolTask task;
+        while (true)
+        {
+            if (popOwn(self, task) || steal(self, task))
+            {
+                runTask(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepLock);
+            wake.wait(lock, [this]() {
+                return stopping || queuedTasks.load(std::memory_order_acquire) > 0;
+            });
+            if (stopping)
+                return;
+        }
+    }
+
+    /**
+     * Takes the newest part from a worker's own queue
+     */
+    bool popOwn(int self, PoolTask& task)
+    {
+        PoolQueue* queue = queues[self];
+        std::lock_guard<std::mutex> guard(queue->lock);
+        if (queue->tasks.empty())
+            return false;
+
+        task = queue->tasks.back();
+        queue->tasks.pop_back();
+        queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * Takes the oldest part from another queue, starting with the one after self
+     * @param self Queue to skip, -1 for a caller of run(), which has none
+     */
+    bool steal(int self, PoolTask& task)
+    {
+        int count = (int)queues.size();
+        for (int i = 1; i <= count; i++)
+        {
+            int victim = (self + i + count) % count;
+            if (victim == self)
+                continue;
+
+            PoolQueue* queue = queues[victim];
+            std::lock_guard<std::mutex> guard(queue->lock);
+            if (queue->tasks.empty())
+                continue;
+
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+            queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Runs one part and counts it done; the release pairs with run()'s wait
+     */
+    void runTask(const PoolTask& task)
+    {
+        (*task.job->task)(task.index);
+        task.job->remaining.fetch_sub(1, std::memory_order_release);
+    }
+};
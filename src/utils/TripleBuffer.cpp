@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * TripleBuffer - Hands the latest value from one producer thread to one consumer thread
+ *
+ * The producer fills its own buffer and publishes it with one atomic swap
+ * against the middle buffer; the consumer swaps the middle buffer for its own
+ * when something new was published. Neither side copies, locks or waits, and
+ * a consumer that falls behind simply skips to the newest value.
+ */
+template <typename T>
+class TripleBuffer
+{
+private:
+    // The middle slot holds a buffer index plus this bit when it is newer than what the consumer has
+    static const uint8_t FRESH_BIT = 4;
+    static const uint8_t INDEX_MASK = 3;
+
+    T buffers[3];
+    int writeIndex;               // Owned by the producer
+    int readIndex;                // Owned by the consumer
+    std::atomic<uint8_t> middle;  // Buffer waiting to be picked up
+
+public:
+    TripleBuffer()
+    {
+        writeIndex = 0;
+        middle.store(1, std::memory_order_relaxed);
+        readIndex = 2;
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * Sets all three buffers to the same value.
+     * Only for setup, while no other thread is using the buffer.
+     * @param value Initial contents
+     */
+    void reset(const T& value)
+    {
+        for (T& buffer : buffers)
+        {
+            buffer = value;
+        }
+        middle.store(middle.load(std::memory_order_relaxed) & INDEX_MASK, std::memory_order_relaxed);
+    }
+
+    /**
+     * Gets the buffer the producer fills next. Its contents are whatever
+     * was published two or more swaps ago, so it must be fully rewritten.
+     */
+    T& writeBuffer()
+    {
+        return buffers[writeIndex];
+    }
+
+    /**
+     * Makes the write buffer the newest value and takes an old one in exchange (producer only)
+     */
+    void publish()
+    {
+        uint8_t previous = middle.exchange(writeIndex | FRESH_BIT, std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    /**
+     * Picks up the newest published value, if there is one (consumer only)
+     * @return True if readBuffer() changed
+     */
+    bool fetch()
+    {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH_BIT))
+            return false;
+
+        uint8_t previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * Gets the value the consumer last fetched
+     */
+    const T& readBuffer() const
+    {
+        return buffers[readIndex];
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include "Terminal.cpp"
+
+/**
+ * WakeSignal - Lets a pipeline stage sleep until another stage has work for it
+ *
+ * The data itself travels through lock-free rings; this only parks an idle
+ * thread. A notify() that arrives while nobody is waiting is remembered, so
+ * the next wait returns straight away instead of missing it.
+ */
+class WakeSignal
+{
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool signalled;
+
+public:
+    WakeSignal()
+    {
+        signalled = false;
+    }
+
+    /**
+     * Wakes the waiting thread, or the next one to wait
+     */
+    void notify()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            signalled = true;
+        }
+        condition.notify_one();
+    }
+
+    /**
+     * Sleeps until notified or until the deadline passes
+     * @param deadline Time to give up waiting, or NO_DEADLINE
+     * @return True if woken by notify()
+     */
+    bool waitUntil(Deadline deadline)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+
+        if (deadline == NO_DEADLINE)
+        {
+            condition.wait(lock, [this] { return signalled; });
+        }
+        else
+        {
+            condition.wait_until(lock, deadline, [this] { return signalled; });
+        }
+
+        bool woken = signalled;
+        signalled = false;
+        return woken;
+    }
+};
@@ -0,0 +1,134 @@
+import argparse
+import os
+import struct
+
+INPUT_FOLDER = "ascii_frames"
+OUTPUT_FILE = "frames.pack"
+
+# Layout shared with utils/FramePack.cpp (little-endian):
+#   header: magic, version, reserved, frame count, width, height
+#   frame count x uint16 delays
+#   (frame count + 1) x uint32 offsets of each frame's runs in the run section
+#   keyframe: width x height cells of frame 0
+#   run section: per frame, the runs turning the previous frame into it
+#                (frame 0's runs turn the last frame back into frame 0)
+#   run: uint16 row, uint16 column, uint16 length, then length cells
+MAGIC = b"MQFP"
+VERSION = 2
+HEADER_FORMAT = "<4sHHIHH"
+RUN_FORMAT = "<HHH"
+
+# Unchanged cells shorter than this between two changes are stored inside one
+# run, since a new run costs a 6 byte record
+RUN_MERGE_GAP = 6
+
+
+def read_frames(folder: str) -> list:
+    """
+    Read every frame_NN.txt file in the folder, in frame order.
+
+    Args:
+        folder (str): Folder containing the ASCII frames.
+
+    Returns:
+        list: One list of text rows per frame.
+    """
+    names = sorted(
+        name
+        for name in os.listdir(folder)
+        if name.startswith("frame_") and name.endswith(".txt")
+    )
+
+    frames = []
+    for name in names:
+        with open(os.path.join(folder, name), "r", encoding="utf-8") as f:
+            frames.append(f.read().split("\n"))
+    return frames
+
+
+def diff_runs(previous: list, current: list) -> bytes:
+    """
+    Encode the cells that differ between two frames as runs.
+
+    Args:
+        previous (list): Rows of the frame on screen.
+        current (list): Rows of the frame to show next.
+
+    Returns:
+        bytes: Run records, empty if the frames are identical.
+    """
+    data = b""
+    for row, (old, new) in enumerate(zip(previous, current)):
+        col = 0
+        while col < len(new):
+            if old[col] == new[col]:
+                col += 1
+                continue
+
+            start = col
+            end = col + 1
+            gap = 0
+            col += 1
+            while col < len(new) and gap < RUN_MERGE_GAP:
+                if old[col] != new[col]:
+                    end = col + 1
+                    gap = 0
+                else:
+                    gap += 1
+                col += 1
+
+            data += struct.pack(RUN_FORMAT, row, start, end - start)
+            data += new[start:end]
+            col = end
+    return data
+
+
+def pack_frames(frames: list, delay: int) -> bytes:
+    """
+    Build a frame pack: header, per-frame delays, a keyframe, then per-frame runs of changed cells.
+
+    Args:
+        frames (list): Frames as lists of text rows.
+        delay (int): Delay of every frame in milliseconds, 0 to follow the console speed.
+
+    Returns:
+        bytes: The packed file contents.
+    """
+    width = max(len(row) for frame in frames for row in frame)
+    height = max(len(frame) for frame in frames)
+
+    # Rows are padded to the widest row and frames to the tallest frame
+    grids = []
+    for frame in frames:
+        rows = frame + [""] * (height - len(frame))
+        grids.append([row.ljust(width).encode("ascii", "replace") for row in rows])
+
+    runs = []
+    for index, grid in enumerate(grids):
+        runs.append(diff_runs(grids[index - 1], grid))
+
+    offsets = [0]
+    for frame_runs in runs:
+        offsets.append(offsets[-1] + len(frame_runs))
+
+    data = struct.pack(HEADER_FORMAT, MAGIC, VERSION, 0, len(frames), width, height)
+    data += struct.pack(f"<{len(frames)}H", *([delay] * len(frames)))
+    data += struct.pack(f"<{len(offsets)}I", *offsets)
+    data += b"".join(grids[0])
+    data += b"".join(runs)
+
+    return data
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Pack ASCII frames into one file")
+    parser.add_argument("--input", default=INPUT_FOLDER)
+    parser.add_argument("--output", default=OUTPUT_FILE)
+    parser.add_argument("--delay", type=int, default=0, help="milliseconds per frame")
+    args = parser.parse_args()
+
+    frames = read_frames(args.input)
+    with open(args.output, "wb") as f:
+        f.write(pack_frames(frames, args.delay))
+
+    print(f"Packed {len(frames)} frames into '{args.output}'")